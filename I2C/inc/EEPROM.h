@@ -0,0 +1,49 @@
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "I2C.h"
+
+// write cycle bound for ACK polling (tWR is 5 ms max on 24Cxx parts)
+#define EEPROM_WRITE_TIMEOUT_US 10000
+
+// use declared enum to read EEPROM operation status
+enum EEPROM_status
+{
+    EEPROM_OK,
+    EEPROM_OUT_OF_RANGE,
+    EEPROM_TIMEOUT,                     // Write cycle did not finish within EEPROM_WRITE_TIMEOUT_US
+    EEPROM_BUS_ERROR                    // I2C error (NACK, arbitration, bus error or timeout)
+};
+
+// throughput accounting
+typedef struct
+{
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+    uint32_t pageWrites;
+    uint32_t ackPolls;                  // Address probes NACKed during a write cycle
+}EEPROM_Stats_Typedef;
+
+// use declared struct to describe a 24Cxx chip
+// ex: (in main code)
+// EEPROM_Typedef eeprom = { .I2Cx = I2C1, .address = 0x50, .addressBytes = 2, .pageSize = 32, .capacity = 4096 };
+typedef struct
+{
+    I2C_TypeDef* I2Cx;                  // Bus master (I2C_Init called)
+    uint8_t address;                    // 7-bit device address (0x50 with A2..A0 low)
+    uint8_t addressBytes;               // Word address bytes: 1 (24C01..24C16) or 2 (24C32 and up)
+    uint16_t pageSize;                  // Page buffer size (8, 16, 32, 64, 128 or 256)
+    uint32_t capacity;                  // Size in bytes
+    uint8_t busy;                       // Write cycle started, completion not seen yet
+    EEPROM_Stats_Typedef stats;
+}EEPROM_Typedef;
+
+// function declaration
+uint8_t EEPROM_Read(EEPROM_Typedef* eeprom, uint32_t address, uint8_t* data, uint32_t length);
+uint8_t EEPROM_Write(EEPROM_Typedef* eeprom, uint32_t address, const uint8_t* data, uint32_t length);
+uint8_t EEPROM_IsBusy(EEPROM_Typedef* eeprom);
+uint8_t EEPROM_WaitReady(EEPROM_Typedef* eeprom);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "Time.h"
+
+// events waiting for dispatch; posts to a full queue are dropped and counted
+#define EVENT_QUEUE_SIZE 32
+
+// longest single sleep of Event_Run (deadlines must stay within 35 minutes)
+#define EVENT_MAX_SLEEP_US 1000000000
+
+// use declared enum to read posting status
+enum Event_status
+{
+    EVENT_OK,
+    EVENT_FULL                      // Queue full, event dropped
+};
+
+// run-to-completion handler, called from Event_Run with the posted argument
+typedef void (*Event_Handler)(uint32_t arg);
+
+// software timer, linked into the timer list (earliest expiry first) while running
+// ex: (in main code)
+// Event_Timer_Typedef blinkTimer = { .callback = onBlink };
+// Event_TimerStart(&blinkTimer, 0, 500000);
+typedef struct Event_Timer Event_Timer_Typedef;
+
+struct Event_Timer
+{
+    Event_Handler callback;         // Called from Event_Run when the timer expires
+    uint32_t arg;                   // Passed to callback
+    uint32_t periodUs;              // Reload interval, 0: one shot
+    uint64_t due;                   // Expiry on the 64-bit microsecond time base
+    Event_Timer_Typedef* next;
+    uint8_t active;
+};
+
+// use declared struct to read event loop counters
+typedef struct
+{
+    uint32_t dispatched;            // Posted events handled
+    uint32_t dropped;               // Posts lost to a full queue
+    uint32_t timersFired;           // Timer callbacks run
+} Event_Stats_Typedef;
+
+// function declaration
+uint8_t Event_Post(Event_Handler handler, uint32_t arg);
+void Event_TimerStart(Event_Timer_Typedef* timer, uint32_t delayUs, uint32_t periodUs);
+void Event_TimerStop(Event_Timer_Typedef* timer);
+void Event_Poll(void);
+void Event_Run(void);
+Event_Stats_Typedef* Event_GetStats(void);
+
+#endif
@@ -2,25 +2,142 @@
 #define BSP_I2C_H_
 
 #include "stm32f401xc.h"
+#include "DMA.h"
+#include "Time.h"
+#include "Event.h"
+#include "Profile.h"
+#include "Trace.h"
 
 // I2C Peripheral Base Addresses
 #define I2C1_BASE_ADDR (void*)I2C1_BASE
 #define I2C2_BASE_ADDR (void*)I2C2_BASE
 #define I2C3_BASE_ADDR (void*)I2C3_BASE
 
+// Bus speed limits
+#define I2C_STANDARD_MODE_MAX 100000
+#define I2C_FAST_MODE_MAX     400000
+
+// OR into a slave address to select 10-bit addressing (header + ADD10 sequence)
+#define I2C_ADDR_10BIT        0x8000
+
+// Upper bound for every blocking wait (START, address, byte, STOP)
+#define I2C_TIMEOUT_US        10000
+
+// Interrupt/DMA transfers are aborted with I2C_TIMEOUT at transfer->timeoutUs, or when 0 at
+// I2C_TIMEOUT_US plus I2C_BYTE_TIMEOUT_US per data byte; the deadline is watched by a TIM5 alarm
+#define I2C_BYTE_TIMEOUT_US   100
+#define I2C_ALARM             TIME_ALARM_CH2
+
+// A transfer started from a completion callback waits this long for the previous STOP to be
+// sent (about 10 us at 100 kHz) instead of failing with I2C_BUSY
+#define I2C_STOP_WAIT_US      50
+
+// Lost arbitration (multi-master bus) is retried this many times before I2C_ERROR_ARLO is returned;
+// blocking retries back off (attempt x I2C_ARLO_BACKOFF_US) before the next START
+#define I2C_ARLO_RETRIES      3
+#define I2C_ARLO_BACKOFF_US   50
+
+// Set value as 1 to enable interrupt driven transfers (I2Cx_EV/I2Cx_ER handlers)
+#define I2C1_INTERRUPT_ENABLE 1
+#define I2C2_INTERRUPT_ENABLE 1
+#define I2C3_INTERRUPT_ENABLE 0
+
+// Remote reads of at least this many registers are fed to DR by DMA (slave mode)
+#define I2C_SLAVE_DMA_THRESHOLD 16
+
+// Set value as 1 to move data phases through DMA in I2C_Transfer_DMA (needs the interrupt enable above)
+// I2C1: DMA1 Stream6 TX / Stream0 RX, I2C2: DMA1 Stream7 TX / Stream3 RX, I2C3: DMA1 Stream4 TX / Stream2 RX
+#define I2C1_DMA_ENABLE 1
+#define I2C2_DMA_ENABLE 0
+#define I2C3_DMA_ENABLE 0
+
+// Transfer status
+enum I2C_status
+{
+    I2C_OK,
+    I2C_BUSY,
+    I2C_ERROR_AF,               // No acknowledge from slave
+    I2C_ERROR_ARLO,             // Arbitration lost
+    I2C_ERROR_BERR,             // Misplaced START/STOP
+    I2C_ERROR_OVR,              // Overrun/underrun
+    I2C_TIMEOUT,                // No progress within I2C_TIMEOUT_US (blocking), deadline missed or aborted
+    I2C_ERROR_DMA               // I2C_Transfer_DMA on an instance without I2Cx_DMA_ENABLE
+};
+
+// Transfer descriptor: write txData, then read rxData after a repeated START
+// (txLength = 0: read only, rxLength = 0: write only)
+typedef struct I2C_Transfer I2C_Transfer_Typedef;
+typedef void (*I2C_Callback_Typedef)(I2C_Transfer_Typedef* transfer);
+
+struct I2C_Transfer
+{
+    uint16_t address;               // 7-bit slave address, or 10-bit address | I2C_ADDR_10BIT
+    const uint8_t* txData;          // Bytes written first (e.g. register pointer)
+    uint16_t txLength;
+    uint8_t* rxData;                // Bytes read after the repeated START
+    uint16_t rxLength;
+    I2C_Callback_Typedef callback;  // Called from interrupt on completion (optional)
+    Event_Handler event;            // Posted to the event loop with the transfer on completion (optional)
+    void* context;                  // Free for the caller
+    uint32_t timeoutUs;             // Abort deadline from the start (0: I2C_BYTE_TIMEOUT_US rule)
+    volatile uint8_t status;        // I2C_BUSY while in progress, then I2C_OK or error
+};
+
+// Per instance counters: CPU cost of the interrupt and DMA engines
+typedef struct
+{
+    uint32_t transfers;             // Completed transfers
+    uint32_t bytes;                 // Data bytes moved (address bytes not included)
+    uint32_t interrupts;            // Event, error and DMA interrupts taken
+    uint32_t collisions;            // Arbitration losses against another master
+} I2C_Stats_Typedef;
+
+// Register map served by I2C_Slave_init: the first byte a master writes sets the register
+// pointer, further bytes are stored from there; reads stream from the pointer.
+// ex: (in main code)
+// I2C_RegisterMap_Typedef regMap = { .registers = regs, .size = sizeof(regs), .writeCallback = onWrite };
+typedef void (*I2C_RegWrite_Typedef)(uint8_t firstReg, uint16_t length);
+
+typedef struct
+{
+    uint8_t* registers;                 // Register memory
+    uint16_t size;                      // Number of registers (1..256)
+    const uint8_t* readOnly;            // Bitmap, bit n set = register n ignores writes (NULL: all writable)
+    I2C_RegWrite_Typedef writeCallback; // Called from interrupt at STOP when registers were written (optional)
+    Event_Handler writeEvent;           // Posted at STOP with (firstReg << 16) | length (optional)
+    volatile uint32_t readCount;        // Remote read transactions served
+    volatile uint32_t writeCount;       // Remote write transactions with data
+    volatile uint32_t rejectCount;      // Bytes dropped on read-only registers
+} I2C_RegisterMap_Typedef;
+
 // I2C Configuration Structure
 typedef struct
 {
-    uint32_t clockSpeed;       // I2C Clock Speed in Hz
+    uint32_t clockSpeed;       // I2C Clock Speed in Hz (up to 100 kHz standard, 400 kHz fast mode)
     uint8_t addressingMode;    // 0 for 7-bit, 1 for 10-bit addressing
-    uint8_t ownAddress;        // Device Own Address (if required)
+    uint16_t ownAddress;       // Device Own Address, 7 or 10 bits following addressingMode
+    uint8_t dutyCycle;         // Fast mode only: 0 for Tlow/Thigh = 2, 1 for 16/9
 } I2C_Config_Typedef;
 
 // Function Prototypes
-void I2C_Init(I2C_TypeDef* I2Cx, I2C_Config_Typedef* config);
-void I2C_Start(I2C_TypeDef* I2Cx, uint8_t slaveAddr, uint8_t isRead);
-void I2C_Write(I2C_TypeDef* I2Cx, uint8_t data);
-uint8_t I2C_Read(I2C_TypeDef* I2Cx, uint8_t ack);
-void I2C_Stop(I2C_TypeDef* I2Cx);
+uint32_t I2C_Init(I2C_TypeDef* I2Cx, I2C_Config_Typedef* config);
+uint8_t I2C_Start(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t isRead);
+uint8_t I2C_Write(I2C_TypeDef* I2Cx, uint8_t data);
+uint8_t I2C_Read(I2C_TypeDef* I2Cx, uint8_t ack, uint8_t* data);
+uint8_t I2C_Stop(I2C_TypeDef* I2Cx);
+uint8_t I2C_ReadBurst(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t* data, uint16_t length);
+uint8_t I2C_ReadRegs(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, uint8_t* data, uint16_t length);
+uint8_t I2C_WriteRegs(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, const uint8_t* data, uint16_t length);
+uint8_t I2C_BusRecovery(I2C_TypeDef* I2Cx);
+
+// Interrupt driven transfers
+uint8_t I2C_Transfer_IT(I2C_TypeDef* I2Cx, I2C_Transfer_Typedef* transfer);
+uint8_t I2C_Transfer_DMA(I2C_TypeDef* I2Cx, I2C_Transfer_Typedef* transfer);
+uint8_t I2C_IsBusy(I2C_TypeDef* I2Cx);
+void I2C_Abort(I2C_TypeDef* I2Cx);
+I2C_Stats_Typedef* I2C_GetStats(I2C_TypeDef* I2Cx);
+
+// Slave register map
+void I2C_Slave_init(I2C_TypeDef* I2Cx, I2C_RegisterMap_Typedef* map);
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef I2C_SCHED_H_
+#define I2C_SCHED_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "I2C.h"
+
+#define I2CSCHED_MAX_LENGTH     16      // Largest register block a job reads
+#define I2CSCHED_LOOKAHEAD_MS   2       // Jobs due this soon join the current batch
+
+// use declared struct to describe a periodic register read
+// ex: (in main code)
+// I2CSched_Job_Typedef accel = { .address = 0x68, .reg = 0x3B, .length = 6, .periodMs = 10 };
+typedef struct
+{
+    uint16_t address;                   // 7-bit slave address, or 10-bit address | I2C_ADDR_10BIT
+    uint8_t reg;                        // First register
+    uint8_t length;                     // Bytes to read (1..I2CSCHED_MAX_LENGTH)
+    uint16_t periodMs;                  // Read period in milliseconds
+
+    // filled in by the scheduler
+    uint8_t buffer[2][I2CSCHED_MAX_LENGTH];     // Published snapshot and the one being read
+    volatile uint8_t front;             // Index of the published snapshot
+    volatile uint32_t sequence;         // Incremented on every publish (0: nothing published yet)
+    volatile uint32_t errorCount;       // Reads that failed (previous snapshot kept)
+    uint32_t due;                       // Next due time in milliseconds
+}I2CSched_Job_Typedef;
+
+// use declared struct to describe a scheduler serving one bus
+// ex: (in main code)
+// I2CSched_Typedef sensors = { .I2Cx = I2C1, .jobs = jobs, .jobCount = 12 };
+typedef struct
+{
+    I2C_TypeDef* I2Cx;                  // Bus master (interrupts enabled in I2C.h)
+    I2CSched_Job_Typedef* jobs;
+    uint8_t jobCount;                   // Up to 32
+
+    // filled in by the scheduler
+    I2C_Transfer_Typedef transfer;
+    volatile uint32_t batch;            // Jobs still to run in the current batch (bit per job)
+    uint8_t current;                    // Job being read
+    uint32_t nowMs;                     // Scheduler time
+    volatile uint32_t batchCount;       // Batches run back-to-back
+    volatile uint32_t readCount;        // Jobs completed
+}I2CSched_Typedef;
+
+// function declaration
+void I2CSched_init(I2CSched_Typedef* sched);
+void I2CSched_Poll(I2CSched_Typedef* sched);
+uint32_t I2CSched_Read(I2CSched_Job_Typedef* job, uint8_t* data);
+
+#endif
@@ -3,11 +3,17 @@
 
 #include <stdio.h>
 #include "stm32f401xc.h"
+#include "Clock.h"
 
-// pheripheral clock
-#define PERIPHERAL_CLK 42000000
+// set value as 1 to send the log over ITM/SWO (PB3) instead of USART1: text writes never
+// block, a byte is dropped when the stimulus port FIFO is full (see Log_Dropped)
+#define LOG_ITM 0
 
-// Initialize UART 1
+#define LOG_SWO_BAUD 2000000        // SWO bit rate, HCLK must be a multiple of it
+#define LOG_ITM_TEXT_PORT 0         // Stimulus port of Log_s/Log_c/Log_i/Log_p
+#define LOG_ITM_DATA_PORT 1         // Stimulus port of Log_b (binary data, e.g. Trace_Dump)
+
+// Initialize UART 1 (or ITM/SWO)
 void Log_init(void);
 
 // Transmit string 
@@ -22,4 +28,10 @@ void Log_i(uint32_t data_Tx);
 // Transmit pointers
 void Log_p(uint32_t* data_Tx);
 
+// Transmit binary byte (ITM: data port, never dropped)
+void Log_b(uint8_t data_Tx);
+
+// Text bytes dropped by a full ITM FIFO
+uint32_t Log_Dropped(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+
+// set value as 1 to let the drivers record their events (start, bytes, error, completion)
+// with DWT cycle timestamps into a RAM buffer; with 0 the trace points expand to nothing
+#define TRACE_ENABLE 0
+
+// records kept (8 bytes each), power of two; the oldest record is overwritten first
+#define TRACE_SIZE 256
+
+#define TRACE_MAGIC 0x31435254      // "TRC1" at the start of the buffer image
+
+// use declared enum to select the record source (tools/trace2chrome.py uses the same order)
+enum Trace_source
+{
+    TRACE_CLOCK,
+    TRACE_USART1,
+    TRACE_USART2,
+    TRACE_USART6,
+    TRACE_SPI1,
+    TRACE_SPI2,
+    TRACE_SPI3,
+    TRACE_I2C1,
+    TRACE_I2C2,
+    TRACE_I2C3,
+    TRACE_APP                       // Application marks
+};
+
+// use declared enum to select the record event
+enum Trace_event
+{
+    TRACE_START,                    // Transfer or frame started (arg: length or address)
+    TRACE_DONE,                     // Ends the START (arg: bytes, 0 if failed or not counted)
+    TRACE_ERROR,                    // Error seen, DONE follows if it ended the transfer
+                                    // (arg: driver status or flags)
+    TRACE_BYTES,                    // Slave transaction ended (arg: bytes)
+    TRACE_RX,                       // Byte received (arg: data)
+    TRACE_RECLOCK,                  // Operating point changed (arg: HCLK in MHz)
+    TRACE_MARK                      // Application mark (arg: free)
+};
+
+// one record, little-endian: cycles, event, source, arg
+typedef struct
+{
+    uint32_t cycles;                // DWT->CYCCNT
+    uint8_t event;
+    uint8_t source;
+    uint16_t arg;
+} Trace_Record_Typedef;
+
+// trace buffer: the same image is read by the debugger (symbol traceBuffer) or sent by
+// Trace_Dump, and decoded by tools/trace2chrome.py
+typedef struct
+{
+    uint32_t magic;                 // TRACE_MAGIC
+    uint16_t size;                  // TRACE_SIZE
+    uint16_t running;               // 0 after Trace_Freeze
+    uint32_t clockHz;               // HCLK at the oldest record, TRACE_RECLOCK records follow changes
+    volatile uint32_t next;         // Records written since Trace_init (slot: next % TRACE_SIZE)
+    Trace_Record_Typedef records[TRACE_SIZE];
+} Trace_Buffer_Typedef;
+
+#if TRACE_ENABLE
+#define TRACE(source, event, arg)   Trace_Record(source, event, arg)
+
+extern Trace_Buffer_Typedef traceBuffer;
+
+// function declaration
+void Trace_init(void);
+void Trace_Record(uint8_t source, uint8_t event, uint16_t arg);
+void Trace_Freeze(void);
+void Trace_Resume(void);
+void Trace_Dump(void (*put)(uint8_t byte));
+#else
+#define TRACE(source, event, arg)
+#endif
+
+#endif
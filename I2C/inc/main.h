@@ -1,6 +1,16 @@
 #include "stm32f401xc.h"
+#include "Clock.h"
+#include "Time.h"
+#include "Event.h"
+#include "Task.h"
+#include "Profile.h"
+#include "Load.h"
+#include "Trace.h"
 #include "I2C.h"
+#include "I2CSched.h"
+#include "EEPROM.h"
 #include "Log.h"
 
 extern void SystemInit(void);
-extern void Delay_ms(uint16_t ms);
+extern void Delay_us(uint32_t us);
+extern void Delay_ms(uint32_t ms);
@@ -0,0 +1,157 @@
+#include "DMA.h"
+
+// bit offset of each stream's flag group inside LISR/HISR (streams 0-3 and 4-7)
+static const uint8_t flagOffset[4] = {0, 6, 16, 22};
+
+/**
+ * @brief  Returns the DMA controller that owns the given stream.
+ */
+static DMA_TypeDef* DMA_Controller(DMA_Stream_TypeDef* stream)
+{
+    return (DMA_TypeDef*)((uint32_t)stream & ~0xFFU);   // Streams live in the first 0x100 bytes of the controller
+}
+
+/**
+ * @brief  Returns the stream number (0-7) of the given stream.
+ */
+static uint8_t DMA_StreamIndex(DMA_Stream_TypeDef* stream)
+{
+    return (((uint32_t)stream & 0xFFU) - 0x10U) / 0x18U; // Stream0 at offset 0x10, 0x18 bytes per stream
+}
+
+/*************************************** Setup DMA ********************************************
+ * @brief  Configures a DMA stream according to the specified parameters in dmaConfig.
+ *
+ * @param  stream: Pointer to DMA stream (DMA1_Stream0 ... DMA2_Stream7)
+ * @param  dmaConfig: Pointer to configuration structure
+ * @note   Enables the controller clock and leaves the stream disabled, ready for DMA_Start.
+ */
+void DMA_init(DMA_Stream_TypeDef* stream, DMA_Config_Typedef* dmaConfig)
+{
+    // Enable the appropriate DMA controller clock
+    if (DMA_Controller(stream) == DMA1)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    }
+    else
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    }
+
+    DMA_Stop(stream);                                           // Stream must be disabled before configuration
+
+    uint32_t cr = (dmaConfig->channel << DMA_SxCR_CHSEL_Pos)    // Request channel
+                | (dmaConfig->priority << DMA_SxCR_PL_Pos)      // Stream priority
+                | (dmaConfig->dataSize << DMA_SxCR_PSIZE_Pos)   // Peripheral data size
+                | (dmaConfig->dataSize << DMA_SxCR_MSIZE_Pos);  // Memory data size
+
+    if (dmaConfig->direction == DMA_MEM_TO_PERIPH)
+    {
+        cr |= DMA_SxCR_DIR_0;                                   // Memory to peripheral
+    }
+    if (dmaConfig->memIncrement)
+    {
+        cr |= DMA_SxCR_MINC;                                    // Increment memory pointer
+    }
+    if (dmaConfig->circular)
+    {
+        cr |= DMA_SxCR_CIRC;                                    // Circular mode
+    }
+    if (dmaConfig->interruptTC)
+    {
+        cr |= DMA_SxCR_TCIE;                                    // Transfer complete interrupt
+    }
+    if (dmaConfig->interruptHT)
+    {
+        cr |= DMA_SxCR_HTIE;                                    // Half transfer interrupt
+    }
+    if (dmaConfig->interruptTC || dmaConfig->interruptHT)
+    {
+        cr |= DMA_SxCR_TEIE;                                    // Report transfer errors as well
+    }
+
+    stream->CR = cr;
+    stream->FCR = 0;                                            // Direct mode, FIFO disabled
+}
+
+/************************************ Start/Stop transfer *************************************
+ * @brief  Starts a transfer of count items between periphAddr and memAddr.
+ *
+ * @param  stream: Pointer to DMA stream
+ * @param  periphAddr: Peripheral data register address
+ * @param  memAddr: Memory buffer address
+ * @param  count: Number of items (of the configured data size) to transfer
+ */
+void DMA_Start(DMA_Stream_TypeDef* stream, volatile void* periphAddr, const void* memAddr, uint16_t count)
+{
+    DMA_Stop(stream);                               // Make sure the stream is idle
+    DMA_ClearFlags(stream, DMA_FLAG_ALL);           // Stale flags would block the enable
+
+    stream->PAR = (uint32_t)periphAddr;             // Peripheral address
+    stream->M0AR = (uint32_t)memAddr;               // Memory address
+    stream->NDTR = count;                           // Number of items
+
+    stream->CR |= DMA_SxCR_EN;                      // Enable stream
+}
+
+void DMA_Stop(DMA_Stream_TypeDef* stream)
+{
+    stream->CR &= ~DMA_SxCR_EN;                     // Request stream disable
+    while (stream->CR & DMA_SxCR_EN);               // Wait until current item has been transferred
+}
+
+/**
+ * @brief  Enables or disables memory increment (stream must be stopped).
+ *         Used to clock dummy bytes out of a single memory location.
+ */
+void DMA_SetMemIncrement(DMA_Stream_TypeDef* stream, uint8_t enable)
+{
+    if (enable)
+    {
+        stream->CR |= DMA_SxCR_MINC;
+    }
+    else
+    {
+        stream->CR &= ~DMA_SxCR_MINC;
+    }
+}
+
+/*************************************** Stream status ****************************************
+ * @brief  Reads or clears the status flags of a stream.
+ *
+ * @param  stream: Pointer to DMA stream
+ * @param  flags: Combination of DMA_FLAG_x (normalised to stream 0 layout)
+ * @return Flags currently set for the stream (DMA_FLAG_x)
+ */
+uint8_t DMA_GetFlags(DMA_Stream_TypeDef* stream)
+{
+    DMA_TypeDef* dma = DMA_Controller(stream);
+    uint8_t index = DMA_StreamIndex(stream);
+    uint32_t isr = (index < 4) ? dma->LISR : dma->HISR;
+
+    return (isr >> flagOffset[index & 3]) & DMA_FLAG_ALL;
+}
+
+void DMA_ClearFlags(DMA_Stream_TypeDef* stream, uint8_t flags)
+{
+    DMA_TypeDef* dma = DMA_Controller(stream);
+    uint8_t index = DMA_StreamIndex(stream);
+    uint32_t mask = (uint32_t)(flags & DMA_FLAG_ALL) << flagOffset[index & 3];
+
+    if (index < 4)
+    {
+        dma->LIFCR = mask;                          // Write 1 to clear
+    }
+    else
+    {
+        dma->HIFCR = mask;
+    }
+}
+
+/**
+ * @brief  Returns the number of items still to be transferred by the stream.
+ */
+uint16_t DMA_Remaining(DMA_Stream_TypeDef* stream)
+{
+    return stream->NDTR;
+}
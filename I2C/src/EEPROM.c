@@ -0,0 +1,166 @@
+#include "EEPROM.h"
+
+/**
+ * @brief  Device address for a memory address: address bits above the word address bytes
+ *         select the block through the low bits of the device address (24C04..24C16, 24C1024).
+ */
+static uint8_t EEPROM_DeviceAddress(EEPROM_Typedef* eeprom, uint32_t address)
+{
+    return eeprom->address | ((address >> (8 * eeprom->addressBytes)) & 0x07);
+}
+
+/**
+ * @brief  START in write direction followed by the word address.
+ */
+static uint8_t EEPROM_Select(EEPROM_Typedef* eeprom, uint32_t address)
+{
+    uint8_t status = I2C_Start(eeprom->I2Cx, EEPROM_DeviceAddress(eeprom, address), 0);
+
+    if (status == I2C_OK && eeprom->addressBytes == 2)
+        status = I2C_Write(eeprom->I2Cx, (address >> 8) & 0xFF);
+    if (status == I2C_OK)
+        status = I2C_Write(eeprom->I2Cx, address & 0xFF);
+
+    return status;
+}
+
+/************************************ Busy handling *******************************************
+ * @brief  A page write returns as soon as STOP starts the internal write cycle. Completion is
+ *         detected by ACK polling (the chip NACKs its address while writing) right before the
+ *         next access, instead of a fixed 5 ms wait.
+ *
+ * @param  eeprom: Pointer to EEPROM descriptor
+ * @return EEPROM_IsBusy: 1 while the write cycle is still running
+ *         EEPROM_WaitReady: EEPROM_OK or EEPROM_TIMEOUT
+ */
+uint8_t EEPROM_IsBusy(EEPROM_Typedef* eeprom)
+{
+    if (eeprom->busy)
+    {
+        if (I2C_Start(eeprom->I2Cx, eeprom->address, 0) != I2C_OK)
+        {
+            eeprom->stats.ackPolls++;               // NACK already released the bus with STOP
+            return 1;
+        }
+        I2C_Stop(eeprom->I2Cx);
+        eeprom->busy = 0;
+    }
+    return 0;
+}
+
+uint8_t EEPROM_WaitReady(EEPROM_Typedef* eeprom)
+{
+    uint32_t deadline = Time_deadline_us(EEPROM_WRITE_TIMEOUT_US);
+
+    while (EEPROM_IsBusy(eeprom))
+    {
+        if (Time_expired(deadline))
+            return EEPROM_TIMEOUT;
+    }
+    return EEPROM_OK;
+}
+
+/*************************************** Read data ********************************************
+ * @brief  Sequential read of an arbitrary range: word address write, then one burst read after
+ *         a repeated START per block (the block is part of the device address).
+ *
+ * @param  eeprom: Pointer to EEPROM descriptor
+ * @param  address: Start address
+ * @param  data: Destination buffer
+ * @param  length: Number of bytes
+ * @return EEPROM_OK, EEPROM_OUT_OF_RANGE, EEPROM_TIMEOUT or EEPROM_BUS_ERROR
+ */
+uint8_t EEPROM_Read(EEPROM_Typedef* eeprom, uint32_t address, uint8_t* data, uint32_t length)
+{
+    uint32_t blockSize = 1UL << (8 * eeprom->addressBytes);
+
+    if (length > eeprom->capacity || address > eeprom->capacity - length)
+    {
+        return EEPROM_OUT_OF_RANGE;                 // address + length could wrap
+    }
+    if (EEPROM_WaitReady(eeprom) != EEPROM_OK)
+    {
+        return EEPROM_TIMEOUT;
+    }
+
+    while (length)
+    {
+        uint32_t chunk = blockSize - (address % blockSize);    // Up to block end
+        if (chunk > length)
+            chunk = length;
+        if (chunk > 0xFFFF)
+            chunk = 0xFFFF;
+
+        uint8_t status = EEPROM_Select(eeprom, address);
+        if (status == I2C_OK)
+            status = I2C_ReadBurst(eeprom->I2Cx, EEPROM_DeviceAddress(eeprom, address), data, chunk);
+        if (status != I2C_OK)
+        {
+            if (status == I2C_TIMEOUT)
+                I2C_Stop(eeprom->I2Cx);
+            return EEPROM_BUS_ERROR;
+        }
+
+        eeprom->stats.bytesRead += chunk;
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return EEPROM_OK;
+}
+
+/*************************************** Write data *******************************************
+ * @brief  Writes an arbitrary range split on page boundaries (a page write wraps inside its
+ *         page). Each page is sent as soon as ACK polling sees the previous write cycle end,
+ *         and the call returns without waiting for the last one.
+ *
+ * @param  eeprom: Pointer to EEPROM descriptor
+ * @param  address: Start address
+ * @param  data: Source buffer
+ * @param  length: Number of bytes
+ * @return EEPROM_OK, EEPROM_OUT_OF_RANGE, EEPROM_TIMEOUT or EEPROM_BUS_ERROR
+ */
+uint8_t EEPROM_Write(EEPROM_Typedef* eeprom, uint32_t address, const uint8_t* data, uint32_t length)
+{
+    if (length > eeprom->capacity || address > eeprom->capacity - length)
+    {
+        return EEPROM_OUT_OF_RANGE;                 // address + length could wrap
+    }
+
+    while (length)
+    {
+        uint32_t chunk = eeprom->pageSize - (address % eeprom->pageSize);  // Up to page end
+        if (chunk > length)
+            chunk = length;
+
+        if (EEPROM_WaitReady(eeprom) != EEPROM_OK)  // Previous page still writing
+        {
+            return EEPROM_TIMEOUT;
+        }
+
+        uint8_t status = EEPROM_Select(eeprom, address);
+        for (uint32_t i = 0; i < chunk && status == I2C_OK; i++)
+        {
+            status = I2C_Write(eeprom->I2Cx, data[i]);
+        }
+        if (status == I2C_OK)
+            status = I2C_Stop(eeprom->I2Cx);        // Write cycle starts on STOP
+        if (status != I2C_OK)
+        {
+            if (status == I2C_TIMEOUT)
+                I2C_Stop(eeprom->I2Cx);
+            return EEPROM_BUS_ERROR;
+        }
+        eeprom->busy = 1;
+
+        eeprom->stats.pageWrites++;
+        eeprom->stats.bytesWritten += chunk;
+
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return EEPROM_OK;
+}
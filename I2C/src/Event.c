@@ -0,0 +1,206 @@
+#include "Event.h"
+
+// Queue slot: claimed by a post, published once handler and arg are written
+typedef struct
+{
+    Event_Handler handler;
+    uint32_t arg;
+    volatile uint8_t ready;
+} Event_Slot_Typedef;
+
+static Event_Slot_Typedef queue[EVENT_QUEUE_SIZE];
+static volatile uint32_t head;                  // Next slot to dispatch (event loop only)
+static volatile uint32_t tail;                  // Next slot to claim (any context)
+
+static Event_Timer_Typedef* timers;             // Running timers, earliest expiry first
+static Event_Stats_Typedef stats;
+
+/*************************************** Post event *******************************************
+ * @brief  Queues handler(arg) for the event loop. Lock-free and safe from any interrupt
+ *         priority and from the loop itself: a slot is claimed with LDREX/STREX, filled, then
+ *         published. Interrupt handlers stay short and the work runs in Event_Run.
+ *
+ * @param  handler: Function run from the event loop
+ * @param  arg: Argument passed to handler
+ * @return EVENT_OK, or EVENT_FULL if EVENT_QUEUE_SIZE events are already waiting
+ */
+uint8_t Event_Post(Event_Handler handler, uint32_t arg)
+{
+    uint32_t slot;
+
+    do
+    {
+        slot = __LDREXW((volatile uint32_t*)&tail);
+        if (slot - head >= EVENT_QUEUE_SIZE)
+        {
+            __CLREX();
+            stats.dropped++;
+            return EVENT_FULL;
+        }
+    } while (__STREXW(slot + 1, (volatile uint32_t*)&tail));    // Retry if another post claimed it
+
+    Event_Slot_Typedef* event = &queue[slot % EVENT_QUEUE_SIZE];
+    event->handler = handler;
+    event->arg = arg;
+    __DMB();                                    // Content visible before the slot is
+    event->ready = 1;
+
+    return EVENT_OK;
+}
+
+/**
+ * @brief  Returns 1 if an event waits for dispatch (Time_sleepUntilWake condition).
+ */
+static uint8_t Event_Pending(void)
+{
+    return queue[head % EVENT_QUEUE_SIZE].ready;
+}
+
+/**
+ * @brief  Runs the oldest posted event.
+ * @note   Interrupts run to completion before the loop resumes, so a claimed slot is always
+ *         published by the time the loop looks at it.
+ */
+static uint8_t Event_Dispatch(void)
+{
+    Event_Slot_Typedef* event = &queue[head % EVENT_QUEUE_SIZE];
+
+    if (!event->ready)
+    {
+        return 0;
+    }
+
+    Event_Handler handler = event->handler;
+    uint32_t arg = event->arg;
+
+    event->ready = 0;
+    __DMB();
+    head++;                                     // Slot free for the next post
+
+    stats.dispatched++;
+    handler(arg);
+    return 1;
+}
+
+/**
+ * @brief  Links a timer into the list, after the timers expiring at the same time.
+ */
+static void Event_TimerInsert(Event_Timer_Typedef* timer)
+{
+    Event_Timer_Typedef** link = &timers;
+
+    while (*link && (*link)->due <= timer->due)
+    {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+    timer->active = 1;
+}
+
+/************************************** Software timers ***************************************
+ * @brief  Starts (or restarts) a timer: callback runs from the event loop after delayUs, then
+ *         every periodUs if periodUs is not 0. Stops a running timer.
+ *
+ * @param  timer: Pointer to timer (callback filled in, must stay valid while running)
+ * @param  delayUs: Time to the first expiry
+ * @param  periodUs: Reload interval, 0: one shot
+ * @note   Event loop context only (handlers and timer callbacks), not interrupts: post an
+ *         event from the interrupt and start the timer from its handler.
+ */
+void Event_TimerStart(Event_Timer_Typedef* timer, uint32_t delayUs, uint32_t periodUs)
+{
+    Event_TimerStop(timer);
+    timer->periodUs = periodUs;
+    timer->due = Time_now_us64() + delayUs;
+    Event_TimerInsert(timer);
+}
+
+void Event_TimerStop(Event_Timer_Typedef* timer)
+{
+    if (!timer->active)
+    {
+        return;
+    }
+    for (Event_Timer_Typedef** link = &timers; *link; link = &(*link)->next)
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->active = 0;
+}
+
+/**
+ * @brief  Runs the callbacks of every expired timer, earliest first. Periodic timers are
+ *         relinked before their callback runs, so the callback may stop or restart them.
+ */
+static void Event_RunTimers(uint64_t now)
+{
+    while (timers && timers->due <= now)
+    {
+        Event_Timer_Typedef* timer = timers;
+
+        timers = timer->next;
+        timer->active = 0;
+        if (timer->periodUs)
+        {
+            timer->due += timer->periodUs;
+            if (timer->due <= now)
+            {
+                timer->due = now + timer->periodUs;     // Fell behind: skip missed periods
+            }
+            Event_TimerInsert(timer);
+        }
+
+        stats.timersFired++;
+        timer->callback(timer->arg);
+    }
+}
+
+/***************************************** Event loop *****************************************
+ * @brief  Event_Poll dispatches the events posted so far (at most one queue length, so
+ *         timers are not starved by a busy interrupt) and the expired timers, then returns.
+ *         Event_Run polls forever and sleeps (WFI) in between until the next timer expires
+ *         or an interrupt posts an event.
+ */
+void Event_Poll(void)
+{
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE && Event_Dispatch(); i++);
+
+    Event_RunTimers(Time_now_us64());
+}
+
+void Event_Run(void)
+{
+    while (1)
+    {
+        Event_Poll();
+
+        uint64_t now = Time_now_us64();
+        uint64_t wait = EVENT_MAX_SLEEP_US;
+
+        if (timers)
+        {
+            wait = (timers->due > now) ? timers->due - now : 0;
+            if (wait > EVENT_MAX_SLEEP_US)
+            {
+                wait = EVENT_MAX_SLEEP_US;
+            }
+        }
+        if (wait)
+        {
+            Time_sleepUntilWake((uint32_t)(now + wait), Event_Pending);
+        }
+    }
+}
+
+/**
+ * @brief  Returns the event loop counters.
+ */
+Event_Stats_Typedef* Event_GetStats(void)
+{
+    return &stats;
+}
@@ -1,21 +1,238 @@
 #include "I2C.h"
 
+// First byte of a 10-bit address: 11110 A9 A8 R/W
+#define I2C_HEADER_10BIT(addr) (0xF0 | (((addr) >> 7) & 0x06))
+
+// SR1 error flags, rc_w0: cleared by writing 0 with every other bit at 1
+#define I2C_SR1_ERRORS (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)
+
+// Interrupt driven master states
+enum I2C_state
+{
+    I2C_STATE_IDLE,
+    I2C_STATE_START,            // START requested, waiting for SB
+    I2C_STATE_TX,               // Writing txData
+    I2C_STATE_RX                // Reading rxData
+};
+
+// Per instance transfer context
+typedef struct
+{
+    I2C_Transfer_Typedef* transfer;
+    uint16_t index;             // Bytes written/read in the current phase
+    volatile uint8_t state;
+    uint8_t dma;                // Data phases moved by DMA
+    uint8_t retries;            // Arbitration losses retried in the current transfer
+    uint8_t header10;           // 10-bit address progress: 0 none, 1 full address sent, 2 read header sent
+    uint32_t deadline;          // Time_deadline_us of the running transfer (I2C_Watchdog)
+    I2C_Stats_Typedef stats;
+    I2C_Config_Typedef* config; // Kept for reinitialization after bus recovery
+    I2C_RegisterMap_Typedef* slave; // Register map served while no master transfer runs
+    uint8_t slaveState;         // I2C_STATE_IDLE, I2C_STATE_TX (remote read) or I2C_STATE_RX (remote write)
+    uint8_t pointer;            // Register pointer, auto-incremented
+    uint8_t pointerSet;         // First byte of the current write received
+    uint8_t writeStart;         // First register written in the current transaction
+    uint16_t written;           // Registers written in the current transaction
+    uint16_t loaded;            // Registers loaded into DR (CPU or DMA) in the current read
+    uint16_t slaveDma;          // Registers handed to DMA in the current read (0: CPU)
+} I2C_Context_Typedef;
+
+static I2C_Context_Typedef i2cContext[3];
+static I2C_TypeDef* const i2cInstance[3] = {I2C1, I2C2, I2C3};
+
+// DMA streams serving each I2C (RM0368 DMA1 request mapping)
+typedef struct
+{
+    DMA_Stream_TypeDef* txStream;
+    DMA_Stream_TypeDef* rxStream;
+    uint8_t channel;
+    IRQn_Type rxIRQ;
+    uint8_t enabled;                // RX complete handler compiled in (I2Cx_DMA_ENABLE)
+} I2C_DMA_Typedef;
+
+static const I2C_DMA_Typedef i2cDMA[3] = {
+    { DMA1_Stream6, DMA1_Stream0, 1, DMA1_Stream0_IRQn, I2C1_DMA_ENABLE },    // I2C1
+    { DMA1_Stream7, DMA1_Stream3, 7, DMA1_Stream3_IRQn, I2C2_DMA_ENABLE },    // I2C2
+    { DMA1_Stream4, DMA1_Stream2, 3, DMA1_Stream2_IRQn, I2C3_DMA_ENABLE }     // I2C3
+};
+
+// SCL/SDA pins of each I2C, as configured in gpioConfig
+typedef struct
+{
+    GPIO_TypeDef* sclPort;
+    uint8_t sclPin;
+    GPIO_TypeDef* sdaPort;
+    uint8_t sdaPin;
+} I2C_Pins_Typedef;
+
+static const I2C_Pins_Typedef i2cPins[3] = {
+    { GPIOB, 6, GPIOB, 7 },     // I2C1: PB6 SCL, PB7 SDA
+    { GPIOB, 10, GPIOB, 9 },    // I2C2: PB10 SCL, PB9 SDA
+    { GPIOA, 8, GPIOB, 4 }      // I2C3: PA8 SCL, PB4 SDA
+};
+
+static void I2C_Complete(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx, uint8_t status);
+static void I2C_ArmWatchdog(void);
+static void I2C_Slave_End(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx);
+static void I2C_Slave_EV_Handler(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx, uint32_t sr1);
+
+/**
+ * @brief  Returns the table index and transfer context of the given I2C instance.
+ */
+static uint8_t I2C_Index(I2C_TypeDef* I2Cx)
+{
+    if (I2Cx == I2C1)
+        return 0;
+    else if (I2Cx == I2C2)
+        return 1;
+    return 2;
+}
+
+static I2C_Context_Typedef* I2C_GetContext(I2C_TypeDef* I2Cx)
+{
+    return &i2cContext[I2C_Index(I2Cx)];
+}
+
+/**
+ * @brief  Programs the bus timing (CR2 FREQ, CCR, TRISE) from the running APB1 clock, rounded
+ *         so the bus never runs above clockSpeed. The peripheral must be disabled (PE = 0).
+ * @return Effective bus speed in Hz, 0 if clockSpeed cannot be reached with the APB1 clock
+ */
+static uint32_t I2C_SetTiming(I2C_TypeDef* I2Cx, const I2C_Config_Typedef* config)
+{
+    // Peripheral clock frequency (CR2), in MHz
+    uint32_t pclk1 = Clock_GetPCLK1();
+    uint32_t freqMHz = pclk1 / 1000000;
+    uint8_t fastMode = config->clockSpeed > I2C_STANDARD_MODE_MAX;
+
+    if (config->clockSpeed == 0 || config->clockSpeed > I2C_FAST_MODE_MAX
+        || freqMHz < (fastMode ? 4 : 2) || freqMHz > 50)
+    {
+        return 0;
+    }
+    I2Cx->CR2 = (I2Cx->CR2 & ~I2C_CR2_FREQ) | (freqMHz & I2C_CR2_FREQ);   // Interrupt/DMA enables kept
+
+    // Clock control register (CCR)
+    uint32_t ccr, effectiveSpeed;
+    if (!fastMode)
+    {
+        // Standard mode: Thigh = Tlow = CCR * Tpclk1
+        ccr = (pclk1 + (2 * config->clockSpeed) - 1) / (2 * config->clockSpeed);
+        if (ccr < 4)
+            ccr = 4;                        // Minimum allowed in standard mode
+        effectiveSpeed = pclk1 / (2 * ccr);
+        I2Cx->CCR = ccr & I2C_CCR_CCR;
+    }
+    else
+    {
+        // Fast mode: DUTY 0 -> Tlow/Thigh = 2 (3 * CCR), DUTY 1 -> 16/9 (25 * CCR)
+        uint32_t periods = config->dutyCycle ? 25 : 3;
+        ccr = (pclk1 + (periods * config->clockSpeed) - 1) / (periods * config->clockSpeed);
+        if (ccr < 1)
+            ccr = 1;
+        effectiveSpeed = pclk1 / (periods * ccr);
+        I2Cx->CCR = I2C_CCR_FS | (config->dutyCycle ? I2C_CCR_DUTY : 0) | (ccr & I2C_CCR_CCR);
+    }
+    if (ccr > I2C_CCR_CCR)
+    {
+        return 0;                           // Rate too low for this APB1 clock
+    }
+
+    // Maximum rise time (TRISE): 1000 ns in standard mode, 300 ns in fast mode
+    if (fastMode)
+        I2Cx->TRISE = ((freqMHz * 300) / 1000 + 1) & I2C_TRISE_TRISE;
+    else
+        I2Cx->TRISE = (freqMHz + 1) & I2C_TRISE_TRISE;
+
+    return effectiveSpeed;
+}
+
+/**
+ * @brief  Reclock notification. Before the change every initialized instance is parked once its
+ *         master transfer (or batch of chained transfers) and slave transaction are over and the
+ *         bus is free (I2C_TIMEOUT_US at most, then the transfer is aborted): PE is cleared with
+ *         interrupts masked so no transfer can start in between. After the change the timing is
+ *         recomputed for the same bus speed and the instance is enabled again.
+ */
+static void I2C_Reclock(uint8_t event)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        I2C_TypeDef* I2Cx = i2cInstance[i];
+        I2C_Context_Typedef* ctx = &i2cContext[i];
+
+        if (!ctx->config)
+        {
+            continue;
+        }
+        if (event == CLOCK_PRE_CHANGE)
+        {
+            uint32_t deadline = Time_deadline_us(I2C_TIMEOUT_US);
+
+            while (1)
+            {
+                __disable_irq();
+                if ((ctx->state == I2C_STATE_IDLE && ctx->slaveState == I2C_STATE_IDLE
+                     && !(I2Cx->SR2 & I2C_SR2_BUSY)) || Time_expired(deadline))
+                {
+                    break;
+                }
+                __enable_irq();                     // Let the transfer progress
+            }
+            I2Cx->CR1 &= ~I2C_CR1_PE;
+            __enable_irq();
+
+            if (ctx->transfer)
+                I2C_Abort(I2Cx);                    // Still running after the timeout
+        }
+        else
+        {
+            I2C_SetTiming(I2Cx, ctx->config);
+            I2Cx->CR1 |= I2C_CR1_PE;
+            if (ctx->slave)
+                I2Cx->CR1 |= I2C_CR1_ACK;           // Cleared with PE, slave acknowledges again
+        }
+    }
+}
+
 /************************************** I2C Initialization ***************************************
  * @brief  Initializes the I2C peripheral with the specified configuration.
  *
  * @param  I2Cx: Pointer to I2C peripheral (I2C1, I2C2, I2C3)
  * @param  config: Pointer to I2C configuration structure
+ * @return Effective bus speed in Hz, 0 if clockSpeed cannot be reached with the APB1 clock
  * @note   Sets up clock, addressing mode, own address, and enables the peripheral.
+ *         Standard mode up to 100 kHz, fast mode (F/S, DUTY) up to 400 kHz.
  */
-void I2C_Init(I2C_TypeDef* I2Cx, I2C_Config_Typedef* config)
+uint32_t I2C_Init(I2C_TypeDef* I2Cx, I2C_Config_Typedef* config)
 {
-    // 1. Enable Clock for the selected I2C peripheral
+    // 1. Enable Clock (and interrupts, if configured) for the selected I2C peripheral
     if (I2Cx == I2C1)
+    {
         RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
+        #if I2C1_INTERRUPT_ENABLE
+        NVIC_EnableIRQ(I2C1_EV_IRQn);
+        NVIC_EnableIRQ(I2C1_ER_IRQn);
+        #endif
+    }
     else if (I2Cx == I2C2)
+    {
         RCC->APB1ENR |= RCC_APB1ENR_I2C2EN;
+        #if I2C2_INTERRUPT_ENABLE
+        NVIC_EnableIRQ(I2C2_EV_IRQn);
+        NVIC_EnableIRQ(I2C2_ER_IRQn);
+        #endif
+    }
     else if (I2Cx == I2C3)
+    {
         RCC->APB1ENR |= RCC_APB1ENR_I2C3EN;
+        #if I2C3_INTERRUPT_ENABLE
+        NVIC_EnableIRQ(I2C3_EV_IRQn);
+        NVIC_EnableIRQ(I2C3_ER_IRQn);
+        #endif
+    }
+
+    I2C_GetContext(I2Cx)->config = config;
 
     // 2. Disable I2C before configuration (recommended)
     I2Cx->CR1 &= ~I2C_CR1_PE;
@@ -24,48 +241,147 @@ void I2C_Init(I2C_TypeDef* I2Cx, I2C_Config_Typedef* config)
     I2Cx->CR1 |= I2C_CR1_SWRST;
     I2Cx->CR1 &= ~I2C_CR1_SWRST;
 
-    // 4. Set peripheral clock frequency (CR2), in MHz
-    uint32_t pclk1 = 42000000;  // APB1 clock is 42 MHz for STM32F4
-    I2Cx->CR2 = (pclk1 / 1000000) & I2C_CR2_FREQ;
-
-    // 5. Configure clock control register (CCR) for desired speed (e.g., 100 kHz)
-    I2Cx->CCR = (pclk1 / (config->clockSpeed * 2)) & 0xFFF;
+    // 4-6. Bus timing (CR2 FREQ, CCR, TRISE) from the running APB1 clock
+    uint32_t effectiveSpeed = I2C_SetTiming(I2Cx, config);
+    if (!effectiveSpeed)
+    {
+        return 0;                           // Rate not achievable with this APB1 clock
+    }
+    Clock_Register(I2C_Reclock);            // Timing follows operating point changes
 
-    // 6. Set maximum rise time (TRISE) for standard mode
-    I2Cx->TRISE = ((pclk1 / 1000000) + 1) & 0x3F;
-
-    // 7. Configure addressing mode and own address
+    // 7. Configure addressing mode and own address (bit 14 must be kept at 1)
     if (config->addressingMode == 1)
-        I2Cx->OAR1 |= I2C_OAR1_ADDMODE;     // 10-bit addressing
+        I2Cx->OAR1 = I2C_OAR1_ADDMODE | (1U << 14) | (config->ownAddress & 0x3FF);    // 10-bit: ADD[9:0]
     else
-        I2Cx->OAR1 &= ~I2C_OAR1_ADDMODE;    // 7-bit addressing
-    I2Cx->OAR1 |= config->ownAddress << 1;  // Set own address (left-aligned for STM32)
+        I2Cx->OAR1 = (1U << 14) | ((config->ownAddress & 0x7F) << 1);               // 7-bit: ADD[7:1]
 
     // 8. Enable the I2C peripheral
     I2Cx->CR1 |= I2C_CR1_PE;
+
+    return effectiveSpeed;
+}
+
+/************************************** Timeout Helpers ********************************************
+ * @brief  Waits and timeouts run on deadlines of the free running microsecond time base (Time.c).
+ */
+static void I2C_DelayUs(uint32_t us)
+{
+    uint32_t deadline = Time_deadline_us(us);
+    while (!Time_expired(deadline));
+}
+
+/**
+ * @brief  Clears the error flags of SR1 and converts them to a status code.
+ *         A NACK is followed by STOP so the bus is released.
+ */
+static uint8_t I2C_ErrorStatus(I2C_TypeDef* I2Cx, uint32_t sr1)
+{
+    uint8_t status = I2C_OK;
+
+    if (sr1 & I2C_SR1_AF)
+    {
+        status = I2C_ERROR_AF;
+        I2Cx->CR1 |= I2C_CR1_STOP;                  // Release the bus after a NACK
+    }
+    else if (sr1 & I2C_SR1_ARLO)
+    {
+        status = I2C_ERROR_ARLO;                    // Hardware already dropped to slave mode
+    }
+    else if (sr1 & I2C_SR1_BERR)
+    {
+        status = I2C_ERROR_BERR;
+    }
+    else if (sr1 & I2C_SR1_OVR)
+    {
+        status = I2C_ERROR_OVR;
+    }
+
+    I2Cx->SR1 = ~I2C_SR1_ERRORS & 0xFFFF;           // rc_w0: no read, flags set meanwhile survive
+    return status;
+}
+
+/**
+ * @brief  Waits for an SR1 event flag, aborting on bus errors or after I2C_TIMEOUT_US.
+ * @return I2C_OK, I2C_ERROR_x or I2C_TIMEOUT
+ */
+static uint8_t I2C_WaitEvent(I2C_TypeDef* I2Cx, uint32_t flag)
+{
+    uint32_t deadline = Time_deadline_us(I2C_TIMEOUT_US);
+
+    while (1)
+    {
+        uint32_t sr1 = I2Cx->SR1;
+
+        if (sr1 & flag)
+            return I2C_OK;
+        if (sr1 & (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR))
+            return I2C_ErrorStatus(I2Cx, sr1);
+        if (Time_expired(deadline))
+            return I2C_TIMEOUT;
+    }
 }
 
 /************************************** I2C Start Condition ***************************************
  * @brief  Generates a START condition and sends the slave address with R/W bit.
  *
  * @param  I2Cx: Pointer to I2C peripheral
- * @param  slaveAddr: 7-bit slave address
+ * @param  slaveAddr: 7-bit slave address, or 10-bit address | I2C_ADDR_10BIT
  * @param  isRead: 0 = write, 1 = read
+ * @return I2C_OK, I2C_ERROR_AF (address NACKed, STOP sent), I2C_ERROR_ARLO/BERR or I2C_TIMEOUT
+ * @note   I2C_SendAddress leaves ADDR pending so I2C_ReadBurst can set ACK/POS before clearing it,
+ *         as the receiver sequences of the reference manual require.
  */
-void I2C_Start(I2C_TypeDef* I2Cx, uint8_t slaveAddr, uint8_t isRead)
+static uint8_t I2C_SendAddress(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t isRead)
 {
+    uint8_t status;
+
     // Generate START condition
     I2Cx->CR1 |= I2C_CR1_START;
 
     // Wait until START condition is generated (SB bit set)
-    while (!(I2Cx->SR1 & I2C_SR1_SB));
+    status = I2C_WaitEvent(I2Cx, I2C_SR1_SB);
+    if (status != I2C_OK)
+        return status;
+
+    if (slaveAddr & I2C_ADDR_10BIT)
+    {
+        // 10-bit: header (write), then the low address byte
+        I2Cx->DR = I2C_HEADER_10BIT(slaveAddr);
+        status = I2C_WaitEvent(I2Cx, I2C_SR1_ADD10);
+        if (status != I2C_OK)
+            return status;
+
+        I2Cx->DR = slaveAddr & 0xFF;
+        status = I2C_WaitEvent(I2Cx, I2C_SR1_ADDR);
+        if (status != I2C_OK || !isRead)
+            return status;
+
+        // Read: repeated START and the header alone with R/W set
+        (void)I2Cx->SR2;
+        I2Cx->CR1 |= I2C_CR1_START;
+        status = I2C_WaitEvent(I2Cx, I2C_SR1_SB);
+        if (status != I2C_OK)
+            return status;
+        I2Cx->DR = I2C_HEADER_10BIT(slaveAddr) | 1;
+    }
+    else
+    {
+        // Send slave address with R/W bit (write:0, read:1)
+        I2Cx->DR = ((slaveAddr & 0x7F) << 1) | isRead;
+    }
 
-    // Send slave address with R/W bit (write:0, read:1)
-    I2Cx->DR = (slaveAddr << 1) | isRead;
+    // Wait until address is sent (ADDR bit set, left pending for the caller)
+    return I2C_WaitEvent(I2Cx, I2C_SR1_ADDR);
+}
+
+uint8_t I2C_Start(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t isRead)
+{
+    uint8_t status = I2C_SendAddress(I2Cx, slaveAddr, isRead);
+    if (status != I2C_OK)
+        return status;
 
-    // Wait until address is sent (ADDR bit set)
-    while (!(I2Cx->SR1 & I2C_SR1_ADDR));
     (void)I2Cx->SR2;    // Clear ADDR flag by reading SR1 then SR2
+    return I2C_OK;
 }
 
 /************************************** I2C Write Data *********************************************
@@ -73,17 +389,22 @@ void I2C_Start(I2C_TypeDef* I2Cx, uint8_t slaveAddr, uint8_t isRead)
  *
  * @param  I2Cx: Pointer to I2C peripheral
  * @param  data: Byte to transmit
+ * @return I2C_OK, I2C_ERROR_AF (byte NACKed, STOP sent), I2C_ERROR_ARLO/BERR or I2C_TIMEOUT
  */
-void I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
+uint8_t I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
 {
+    uint8_t status;
+
     // Wait until data register is empty (TXE set)
-    while (!(I2Cx->SR1 & I2C_SR1_TXE));
+    status = I2C_WaitEvent(I2Cx, I2C_SR1_TXE);
+    if (status != I2C_OK)
+        return status;
 
     // Write data to data register
     I2Cx->DR = data;
 
     // Wait until byte transfer is finished (BTF set)
-    while (!(I2Cx->SR1 & I2C_SR1_BTF));
+    return I2C_WaitEvent(I2Cx, I2C_SR1_BTF);
 }
 
 /************************************** I2C Read Data **********************************************
@@ -91,10 +412,13 @@ void I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
  *
  * @param  I2Cx: Pointer to I2C peripheral
  * @param  ack: 1 = send ACK after reception, 0 = send NACK (for last byte)
- * @return Received byte
+ * @param  data: Received byte
+ * @return I2C_OK, I2C_ERROR_ARLO/BERR or I2C_TIMEOUT
  */
-uint8_t I2C_Read(I2C_TypeDef* I2Cx, uint8_t ack)
+uint8_t I2C_Read(I2C_TypeDef* I2Cx, uint8_t ack, uint8_t* data)
 {
+    uint8_t status;
+
     // Configure ACK control
     if (ack)
         I2Cx->CR1 |= I2C_CR1_ACK;
@@ -102,17 +426,1041 @@ uint8_t I2C_Read(I2C_TypeDef* I2Cx, uint8_t ack)
         I2Cx->CR1 &= ~I2C_CR1_ACK;
 
     // Wait until data is received (RXNE set)
-    while (!(I2Cx->SR1 & I2C_SR1_RXNE));
+    status = I2C_WaitEvent(I2Cx, I2C_SR1_RXNE);
+    if (status != I2C_OK)
+        return status;
 
     // Return received data
-    return I2Cx->DR;
+    *data = I2Cx->DR;
+    return I2C_OK;
 }
 
 /************************************** I2C Stop Condition ******************************************
  * @brief  Generates a STOP condition on the I2C bus.
  * @param  I2Cx: Pointer to I2C peripheral
+ * @return I2C_OK, or I2C_TIMEOUT if the STOP could not be generated (bus stuck)
  */
-void I2C_Stop(I2C_TypeDef* I2Cx)
+uint8_t I2C_Stop(I2C_TypeDef* I2Cx)
 {
+    uint32_t deadline = Time_deadline_us(I2C_TIMEOUT_US);
+
     I2Cx->CR1 |= I2C_CR1_STOP;
+
+    // Hardware clears STOP once the condition has been generated
+    while (I2Cx->CR1 & I2C_CR1_STOP)
+    {
+        if (Time_expired(deadline))
+            return I2C_TIMEOUT;
+    }
+    return I2C_OK;
+}
+
+/**
+ * @brief  Ends a failed blocking transaction. After lost arbitration the hardware has already
+ *         dropped to slave mode and released the bus, so no STOP is requested then.
+ */
+static void I2C_Release(I2C_TypeDef* I2Cx, uint8_t status)
+{
+    if (status != I2C_ERROR_ARLO)
+        I2Cx->CR1 |= I2C_CR1_STOP;
+}
+
+/**
+ * @brief  Counts a collision and decides whether the transaction is tried again. The backoff
+ *         grows with each attempt; the START of the retry is held by hardware until the
+ *         winning master has sent its STOP.
+ * @return 1 to retry, 0 once I2C_ARLO_RETRIES is exhausted
+ */
+static uint8_t I2C_Collision(I2C_TypeDef* I2Cx, uint8_t attempt)
+{
+    I2C_GetContext(I2Cx)->stats.collisions++;
+
+    if (attempt >= I2C_ARLO_RETRIES)
+        return 0;
+
+    I2C_DelayUs((uint32_t)(attempt + 1) * I2C_ARLO_BACKOFF_US);
+    return 1;
+}
+
+/************************************** I2C Burst Read **********************************************
+ * @brief  Reads len bytes from a slave with the reference manual receiver sequences (RM0368 27.3.3):
+ *         N = 1: ACK cleared before ADDR is cleared, STOP right after
+ *         N = 2: POS set, NACK armed for the second byte, both bytes read after BTF
+ *         N > 2: bytes read on RXNE until three remain, then NACK and STOP are placed with BTF
+ *         so no extra byte is clocked out. A START issued while the bus is owned (after a write
+ *         without STOP) is a repeated START.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral
+ * @param  slaveAddr: 7-bit slave address, or 10-bit address | I2C_ADDR_10BIT
+ * @param  data: Destination buffer
+ * @param  length: Number of bytes (>= 1)
+ * @return I2C_OK, I2C_ERROR_AF, I2C_ERROR_ARLO/BERR or I2C_TIMEOUT (STOP sent on failure)
+ * @note   Lost arbitration is retried up to I2C_ARLO_RETRIES times (also for the register access).
+ */
+static uint8_t I2C_ReadBurstOnce(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t* data, uint16_t length)
+{
+    uint8_t status;
+
+    if (length == 0)
+        return I2C_OK;
+
+    I2Cx->CR1 &= ~I2C_CR1_POS;
+    I2Cx->CR1 |= I2C_CR1_ACK;
+
+    status = I2C_SendAddress(I2Cx, slaveAddr, 1);
+    if (status != I2C_OK)
+    {
+        I2C_Release(I2Cx, status);
+        return status;
+    }
+
+    if (length == 1)
+    {
+        I2Cx->CR1 &= ~I2C_CR1_ACK;
+        __disable_irq();                            // ADDR clear and STOP must not be separated
+        (void)I2Cx->SR2;
+        I2Cx->CR1 |= I2C_CR1_STOP;
+        __enable_irq();
+
+        status = I2C_WaitEvent(I2Cx, I2C_SR1_RXNE);
+        if (status == I2C_OK)
+            data[0] = I2Cx->DR;
+    }
+    else if (length == 2)
+    {
+        I2Cx->CR1 |= I2C_CR1_POS;                   // ACK/NACK applies to the next byte
+        __disable_irq();
+        (void)I2Cx->SR2;
+        I2Cx->CR1 &= ~I2C_CR1_ACK;                  // Second byte is NACKed
+        __enable_irq();
+
+        status = I2C_WaitEvent(I2Cx, I2C_SR1_BTF);  // Byte 1 in DR, byte 2 in shift register
+        if (status == I2C_OK)
+        {
+            __disable_irq();
+            I2Cx->CR1 |= I2C_CR1_STOP;
+            data[0] = I2Cx->DR;
+            __enable_irq();
+            data[1] = I2Cx->DR;
+        }
+        I2Cx->CR1 &= ~I2C_CR1_POS;
+    }
+    else
+    {
+        uint16_t index = 0;
+
+        (void)I2Cx->SR2;
+
+        while (status == I2C_OK && (length - index) > 3)
+        {
+            status = I2C_WaitEvent(I2Cx, I2C_SR1_RXNE);
+            if (status == I2C_OK)
+                data[index++] = I2Cx->DR;
+        }
+
+        // Three bytes left: N-2 in DR, N-1 in shift register, slave stretching on N
+        if (status == I2C_OK)
+            status = I2C_WaitEvent(I2Cx, I2C_SR1_BTF);
+        if (status == I2C_OK)
+        {
+            I2Cx->CR1 &= ~I2C_CR1_ACK;              // NACK the last byte
+            data[index++] = I2Cx->DR;               // N-2
+            status = I2C_WaitEvent(I2Cx, I2C_SR1_BTF);
+        }
+        if (status == I2C_OK)
+        {
+            __disable_irq();
+            I2Cx->CR1 |= I2C_CR1_STOP;
+            data[index++] = I2Cx->DR;               // N-1
+            __enable_irq();
+            status = I2C_WaitEvent(I2Cx, I2C_SR1_RXNE);
+            if (status == I2C_OK)
+                data[index] = I2Cx->DR;             // N
+        }
+    }
+
+    if (status != I2C_OK)
+        I2C_Release(I2Cx, status);                  // Release the bus after a failed phase
+
+    return status;
+}
+
+uint8_t I2C_ReadBurst(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t* data, uint16_t length)
+{
+    uint8_t status;
+    uint8_t attempt = 0;
+
+    do
+    {
+        status = I2C_ReadBurstOnce(I2Cx, slaveAddr, data, length);
+    } while (status == I2C_ERROR_ARLO && I2C_Collision(I2Cx, attempt++));
+
+    return status;
+}
+
+/************************************** I2C Register Access *****************************************
+ * @brief  Register oriented transfers used by sensor drivers: the register pointer is written
+ *         first, then data is read after a repeated START (I2C_ReadRegs) or written in the same
+ *         transaction (I2C_WriteRegs). Registers auto-increment on most devices.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral
+ * @param  slaveAddr: 7-bit slave address, or 10-bit address | I2C_ADDR_10BIT
+ * @param  reg: First register
+ * @param  data: Destination/source buffer
+ * @param  length: Number of bytes
+ * @return I2C_OK, I2C_ERROR_AF, I2C_ERROR_ARLO/BERR or I2C_TIMEOUT (STOP sent on failure)
+ */
+static uint8_t I2C_ReadRegsOnce(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, uint8_t* data, uint16_t length)
+{
+    uint8_t status = I2C_Start(I2Cx, slaveAddr, 0);
+
+    if (status == I2C_OK)
+        status = I2C_Write(I2Cx, reg);
+    if (status != I2C_OK)
+    {
+        I2C_Release(I2Cx, status);
+        return status;
+    }
+
+    return I2C_ReadBurstOnce(I2Cx, slaveAddr, data, length);     // Repeated START
+}
+
+static uint8_t I2C_WriteRegsOnce(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, const uint8_t* data, uint16_t length)
+{
+    uint8_t status = I2C_Start(I2Cx, slaveAddr, 0);
+
+    if (status == I2C_OK)
+        status = I2C_Write(I2Cx, reg);
+    for (uint16_t i = 0; i < length && status == I2C_OK; i++)
+    {
+        status = I2C_Write(I2Cx, data[i]);
+    }
+
+    if (status == I2C_OK)
+        return I2C_Stop(I2Cx);
+
+    I2C_Release(I2Cx, status);
+    return status;
+}
+
+uint8_t I2C_ReadRegs(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, uint8_t* data, uint16_t length)
+{
+    uint8_t status;
+    uint8_t attempt = 0;
+
+    do
+    {
+        status = I2C_ReadRegsOnce(I2Cx, slaveAddr, reg, data, length);
+    } while (status == I2C_ERROR_ARLO && I2C_Collision(I2Cx, attempt++));
+
+    return status;
+}
+
+uint8_t I2C_WriteRegs(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t reg, const uint8_t* data, uint16_t length)
+{
+    uint8_t status;
+    uint8_t attempt = 0;
+
+    do
+    {
+        status = I2C_WriteRegsOnce(I2Cx, slaveAddr, reg, data, length);
+    } while (status == I2C_ERROR_ARLO && I2C_Collision(I2Cx, attempt++));
+
+    return status;
+}
+
+/************************************** I2C Bus Recovery ********************************************
+ * @brief  Frees a bus held by a slave stuck in the middle of a byte: SCL and SDA are taken over as
+ *         open-drain GPIO, up to nine SCL pulses are clocked until SDA is released, a STOP is
+ *         generated by hand and the peripheral is reset and reinitialized.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral (I2C_Init called before)
+ * @return I2C_OK if SDA is released, I2C_ERROR_BERR if the bus is still held low
+ */
+uint8_t I2C_BusRecovery(I2C_TypeDef* I2Cx)
+{
+    const I2C_Pins_Typedef* pins = &i2cPins[I2C_Index(I2Cx)];
+    uint32_t sclMask = 1U << pins->sclPin;
+    uint32_t sdaMask = 1U << pins->sdaPin;
+    uint8_t status = I2C_OK;
+
+    // 1. Disable the peripheral and drive both lines from GPIO (open-drain, released high)
+    I2Cx->CR1 &= ~I2C_CR1_PE;
+    pins->sclPort->BSRR = sclMask;
+    pins->sdaPort->BSRR = sdaMask;
+    pins->sclPort->MODER = (pins->sclPort->MODER & ~(3U << (pins->sclPin * 2))) | (1U << (pins->sclPin * 2));
+    pins->sdaPort->MODER = (pins->sdaPort->MODER & ~(3U << (pins->sdaPin * 2))) | (1U << (pins->sdaPin * 2));
+
+    // 2. Clock out up to nine pulses until the slave releases SDA (5 us half period, 100 kHz)
+    for (uint8_t i = 0; i < 9 && !(pins->sdaPort->IDR & sdaMask); i++)
+    {
+        pins->sclPort->BSRR = sclMask << 16;        // SCL low
+        I2C_DelayUs(5);
+        pins->sclPort->BSRR = sclMask;              // SCL high (released)
+        I2C_DelayUs(5);
+    }
+
+    // 3. STOP: SDA rises while SCL is high
+    pins->sdaPort->BSRR = sdaMask << 16;            // SDA low
+    I2C_DelayUs(5);
+    pins->sclPort->BSRR = sclMask;                  // SCL high
+    I2C_DelayUs(5);
+    pins->sdaPort->BSRR = sdaMask;                  // SDA high -> STOP
+    I2C_DelayUs(5);
+
+    if (!(pins->sdaPort->IDR & sdaMask) || !(pins->sclPort->IDR & sclMask))
+        status = I2C_ERROR_BERR;                    // Line still held low
+
+    // 4. Give the pins back to the peripheral
+    pins->sclPort->MODER = (pins->sclPort->MODER & ~(3U << (pins->sclPin * 2))) | (2U << (pins->sclPin * 2));
+    pins->sdaPort->MODER = (pins->sdaPort->MODER & ~(3U << (pins->sdaPin * 2))) | (2U << (pins->sdaPin * 2));
+
+    // 5. Reset and reinitialize the peripheral (clears BUSY left over from the stuck transfer)
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    if (ctx->config)
+        I2C_Init(I2Cx, ctx->config);
+    if (ctx->transfer)
+        I2C_Complete(I2Cx, ctx, I2C_ERROR_BERR);    // Abandon a transfer caught by the stuck bus
+
+    return status;
+}
+
+/************************************** Interrupt Transfer *****************************************
+ * @brief  Starts a write, read or write-then-read transaction described by transfer.
+ *         The event/error interrupts run the whole sequence; completion is reported through
+ *         transfer->status and the optional callback.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral (interrupts enabled in I2C.h)
+ * @param  transfer: Pointer to transfer descriptor (must stay valid until completion)
+ * @return I2C_OK if started, I2C_BUSY if a transfer is already running or the STOP of the
+ *         previous one is still pending after I2C_STOP_WAIT_US
+ * @note   A transfer still running at its deadline (transfer->timeoutUs, e.g. a slave holding
+ *         SCL low) is aborted by I2C_Watchdog and completes with I2C_TIMEOUT.
+ */
+static uint8_t I2C_StartTransfer(I2C_TypeDef* I2Cx, I2C_Transfer_Typedef* transfer, uint8_t dma)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+
+    if (ctx->state != I2C_STATE_IDLE)
+    {
+        return I2C_BUSY;
+    }
+
+    uint32_t deadline = Time_deadline_us(I2C_STOP_WAIT_US);
+    while (I2Cx->CR1 & I2C_CR1_STOP)                // Previous STOP still on the bus, e.g. when
+    {                                               // chained from a completion callback
+        if (Time_expired(deadline))
+            return I2C_BUSY;
+    }
+
+    transfer->status = I2C_BUSY;
+    ctx->transfer = transfer;
+    ctx->index = 0;
+    ctx->dma = dma;
+    ctx->header10 = 0;
+    ctx->retries = 0;
+    ctx->deadline = Time_deadline_us(transfer->timeoutUs ? transfer->timeoutUs
+                                     : I2C_TIMEOUT_US + I2C_BYTE_TIMEOUT_US * (transfer->txLength + transfer->rxLength));
+    ctx->state = I2C_STATE_START;
+    I2C_ArmWatchdog();
+    TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_START, transfer->address);
+
+    I2Cx->CR1 &= ~I2C_CR1_POS;
+    I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN;
+    I2Cx->CR1 |= I2C_CR1_START;                     // Everything else happens in the ISR
+
+    return I2C_OK;
+}
+
+uint8_t I2C_Transfer_IT(I2C_TypeDef* I2Cx, I2C_Transfer_Typedef* transfer)
+{
+    return I2C_StartTransfer(I2Cx, transfer, 0);
+}
+
+/*************************************** DMA Transfer **********************************************
+ * @brief  Same transaction as I2C_Transfer_IT, but data phases are moved by DMA: the CPU only
+ *         handles START, address and completion. Reads of 2 bytes or more use LAST so the
+ *         hardware NACKs the final byte; single byte reads fall back to the interrupt sequence.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral (interrupts and DMA enabled in I2C.h)
+ * @param  transfer: Pointer to transfer descriptor (must stay valid until completion)
+ * @return I2C_OK if started, I2C_BUSY if a transfer is already running, I2C_ERROR_DMA if
+ *         I2Cx_DMA_ENABLE is 0 (its RX complete interrupt would hit Default_Handler)
+ */
+uint8_t I2C_Transfer_DMA(I2C_TypeDef* I2Cx, I2C_Transfer_Typedef* transfer)
+{
+    const I2C_DMA_Typedef* dma = &i2cDMA[I2C_Index(I2Cx)];
+
+    if (!dma->enabled)
+    {
+        return I2C_ERROR_DMA;
+    }
+    if (I2C_IsBusy(I2Cx))
+    {
+        return I2C_BUSY;
+    }
+
+    DMA_Config_Typedef txConfig = {
+        .channel = dma->channel,
+        .direction = DMA_MEM_TO_PERIPH,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = 1,
+        .priority = 1
+    };
+    DMA_Config_Typedef rxConfig = {
+        .channel = dma->channel,
+        .direction = DMA_PERIPH_TO_MEM,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = 1,
+        .priority = 2,
+        .interruptTC = 1                            // STOP is generated from the RX complete interrupt
+    };
+    DMA_init(dma->txStream, &txConfig);
+    DMA_init(dma->rxStream, &rxConfig);
+    NVIC_EnableIRQ(dma->rxIRQ);
+
+    return I2C_StartTransfer(I2Cx, transfer, 1);
+}
+
+/**
+ * @brief  Aborts a running interrupt/DMA transfer that missed its deadline: a STOP is sent
+ *         and the transfer completes with I2C_TIMEOUT. Use I2C_BusRecovery if the bus stays busy.
+ */
+void I2C_Abort(I2C_TypeDef* I2Cx)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();                                // Do not race the event interrupt
+    if (ctx->transfer)
+    {
+        I2Cx->CR1 |= I2C_CR1_STOP;
+        I2C_Complete(I2Cx, ctx, I2C_TIMEOUT);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Transfer watchdog, run from the TIM5 alarm: aborts every interrupt/DMA transfer past
+ *         its deadline, then rearms for the earliest deadline still pending. One alarm serves
+ *         all instances; a transfer that completes in time leaves it to fire once for nothing.
+ */
+static void I2C_Watchdog(void)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (i2cContext[i].transfer && Time_expired(i2cContext[i].deadline))
+        {
+            I2C_Abort(i2cInstance[i]);
+        }
+    }
+    I2C_ArmWatchdog();
+}
+
+static void I2C_ArmWatchdog(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t earliest = 0;
+    uint8_t pending = 0;
+
+    __disable_irq();                                // Called from thread and interrupt context
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        I2C_Context_Typedef* ctx = &i2cContext[i];
+
+        if (ctx->transfer && (!pending || (int32_t)(ctx->deadline - earliest) < 0))
+        {
+            earliest = ctx->deadline;
+            pending = 1;
+        }
+    }
+    if (pending)
+    {
+        Time_alarm(I2C_ALARM, earliest, I2C_Watchdog);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Returns the transfer counters of the given I2C instance.
+ */
+I2C_Stats_Typedef* I2C_GetStats(I2C_TypeDef* I2Cx)
+{
+    return &I2C_GetContext(I2Cx)->stats;
+}
+
+/**
+ * @brief  Returns 1 while an interrupt driven transfer is in progress.
+ */
+uint8_t I2C_IsBusy(I2C_TypeDef* I2Cx)
+{
+    return I2C_GetContext(I2Cx)->state != I2C_STATE_IDLE;
+}
+
+/************************************** Slave Register Map ******************************************
+ * @brief  Serves a register map to remote masters from the event/error interrupts:
+ *         write: first byte sets the register pointer, further bytes are stored from there
+ *                (read-only registers are skipped), writeCallback runs at STOP
+ *         read:  registers stream from the pointer; the first byte is loaded as soon as the address
+ *                matches, and reads of I2C_SLAVE_DMA_THRESHOLD registers or more are fed by DMA
+ *         The pointer auto-increments, wraps at map->size and persists between transactions.
+ *
+ * @param  I2Cx: Pointer to I2C peripheral (I2C_Init called, interrupts enabled in I2C.h)
+ * @param  map: Pointer to register map (must stay valid while serving)
+ * @note   Master transfers may share the instance; slave events are served while none is running.
+ */
+void I2C_Slave_init(I2C_TypeDef* I2Cx, I2C_RegisterMap_Typedef* map)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    const I2C_DMA_Typedef* dma = &i2cDMA[I2C_Index(I2Cx)];
+
+    DMA_Config_Typedef txConfig = {
+        .channel = dma->channel,
+        .direction = DMA_MEM_TO_PERIPH,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = 1,
+        .priority = 2                               // Master is waiting on every byte
+    };
+    DMA_init(dma->txStream, &txConfig);
+
+    ctx->slave = map;
+    ctx->slaveState = I2C_STATE_IDLE;
+    ctx->pointer = 0;
+    ctx->slaveDma = 0;
+
+    I2Cx->CR1 |= I2C_CR1_ACK;                       // Acknowledge own address and written bytes
+    I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN;
+}
+
+/**
+ * @brief  Returns the register at the pointer and advances it.
+ */
+static uint8_t I2C_Slave_NextByte(I2C_Context_Typedef* ctx)
+{
+    I2C_RegisterMap_Typedef* map = ctx->slave;
+    uint8_t value = map->registers[ctx->pointer];
+
+    ctx->pointer = (ctx->pointer + 1 < map->size) ? ctx->pointer + 1 : 0;
+    ctx->loaded++;
+    return value;
+}
+
+/**
+ * @brief  Closes the current slave transaction (STOP, NACK or bus error).
+ *         The byte loaded into DR when the master NACKed was never clocked out,
+ *         so the pointer is moved back over it (and over bytes DMA did not move).
+ */
+static void I2C_Slave_End(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx)
+{
+    I2C_RegisterMap_Typedef* map = ctx->slave;
+
+    if (ctx->slaveState == I2C_STATE_TX)
+    {
+        uint16_t unsent = 1;
+
+        if (ctx->slaveDma)
+        {
+            DMA_Stream_TypeDef* stream = i2cDMA[I2C_Index(I2Cx)].txStream;
+            unsent += DMA_Remaining(stream);
+            DMA_Stop(stream);
+            I2Cx->CR2 &= ~I2C_CR2_DMAEN;
+            I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+            ctx->slaveDma = 0;
+        }
+        if (unsent > ctx->loaded)
+            unsent = ctx->loaded;
+
+        ctx->pointer = (ctx->pointer + map->size - (unsent % map->size)) % map->size;
+        ctx->stats.bytes += ctx->loaded - unsent;
+        map->readCount++;
+        TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_BYTES, ctx->loaded - unsent);
+    }
+    else if (ctx->slaveState == I2C_STATE_RX && ctx->written)
+    {
+        ctx->stats.bytes += ctx->written;
+        map->writeCount++;
+        TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_BYTES, ctx->written);
+        if (map->writeCallback)
+        {
+            map->writeCallback(ctx->writeStart, ctx->written);
+        }
+        if (map->writeEvent)
+        {
+            Event_Post(map->writeEvent, ((uint32_t)ctx->writeStart << 16) | ctx->written);
+        }
+    }
+
+    ctx->slaveState = I2C_STATE_IDLE;
+}
+
+/**
+ * @brief  Slave side of the event interrupt.
+ */
+static void I2C_Slave_EV_Handler(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx, uint32_t sr1)
+{
+    I2C_RegisterMap_Typedef* map = ctx->slave;
+
+    // Own address matched (ADDR cleared by the SR2 read)
+    if (sr1 & I2C_SR1_ADDR)
+    {
+        uint32_t sr2 = I2Cx->SR2;
+
+        if (ctx->slaveState != I2C_STATE_IDLE)
+            I2C_Slave_End(I2Cx, ctx);               // Repeated START ends the previous phase
+
+        ctx->loaded = 0;
+        if (sr2 & I2C_SR2_TRA)
+        {
+            uint16_t remaining = map->size - ctx->pointer;
+
+            ctx->slaveState = I2C_STATE_TX;
+            if (remaining >= I2C_SLAVE_DMA_THRESHOLD)
+            {
+                // DMA feeds DR up to the end of the map; a longer read continues on BTF
+                ctx->slaveDma = remaining;
+                ctx->loaded = remaining;
+                I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;
+                DMA_Start(i2cDMA[I2C_Index(I2Cx)].txStream, &I2Cx->DR, &map->registers[ctx->pointer], remaining);
+                ctx->pointer = 0;
+                I2Cx->CR2 |= I2C_CR2_DMAEN;
+            }
+            else
+            {
+                I2Cx->DR = I2C_Slave_NextByte(ctx); // Loaded at once, the master is stretched only for the ISR
+            }
+        }
+        else
+        {
+            ctx->slaveState = I2C_STATE_RX;
+            ctx->pointerSet = 0;
+            ctx->written = 0;
+        }
+        return;
+    }
+
+    // Byte written by the master
+    if (sr1 & I2C_SR1_RXNE)
+    {
+        uint8_t value = I2Cx->DR;
+
+        if (!ctx->pointerSet)
+        {
+            ctx->pointer = (value < map->size) ? value : 0;
+            ctx->writeStart = ctx->pointer;
+            ctx->pointerSet = 1;
+        }
+        else
+        {
+            if (map->readOnly && (map->readOnly[ctx->pointer >> 3] & (1U << (ctx->pointer & 7))))
+                map->rejectCount++;
+            else
+                map->registers[ctx->pointer] = value;
+
+            ctx->written++;
+            ctx->pointer = (ctx->pointer + 1 < map->size) ? ctx->pointer + 1 : 0;
+        }
+    }
+
+    // Next byte requested by the master (BTF once DMA has run out)
+    if ((sr1 & (I2C_SR1_TXE | I2C_SR1_BTF)) && ctx->slaveState == I2C_STATE_TX)
+    {
+        if (ctx->slaveDma && DMA_Remaining(i2cDMA[I2C_Index(I2Cx)].txStream) == 0)
+        {
+            DMA_Stop(i2cDMA[I2C_Index(I2Cx)].txStream);
+            I2Cx->CR2 &= ~I2C_CR2_DMAEN;
+            I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+            ctx->slaveDma = 0;
+        }
+        if (!ctx->slaveDma)
+            I2Cx->DR = I2C_Slave_NextByte(ctx);
+    }
+
+    // STOP detected: cleared by the SR1 read above followed by a CR1 write
+    if (sr1 & I2C_SR1_STOPF)
+    {
+        I2Cx->CR1 |= I2C_CR1_PE;
+        I2C_Slave_End(I2Cx, ctx);
+    }
+}
+
+/**
+ * @brief  Ends the current transfer: interrupts off, status published, callback run.
+ */
+static void I2C_Complete(I2C_TypeDef* I2Cx, I2C_Context_Typedef* ctx, uint8_t status)
+{
+    I2C_Transfer_Typedef* transfer = ctx->transfer;
+
+    I2Cx->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+    I2Cx->CR1 &= ~I2C_CR1_POS;
+    if (ctx->dma)
+    {
+        DMA_Stop(i2cDMA[I2C_Index(I2Cx)].txStream);
+        DMA_Stop(i2cDMA[I2C_Index(I2Cx)].rxStream);
+    }
+    ctx->state = I2C_STATE_IDLE;
+    ctx->transfer = 0;
+
+    if (ctx->slave)
+    {
+        I2Cx->CR1 |= I2C_CR1_ACK;                   // Back to answering our own address
+        I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN;
+    }
+
+    if (status == I2C_OK)
+    {
+        ctx->stats.transfers++;
+        ctx->stats.bytes += transfer->txLength + transfer->rxLength;
+    }
+    else
+    {
+        TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_ERROR, status);
+    }
+    TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_DONE,
+          (status == I2C_OK) ? transfer->txLength + transfer->rxLength : 0);
+
+    transfer->status = status;
+    if (transfer->callback)
+    {
+        transfer->callback(transfer);               // May start the next transfer
+    }
+    if (transfer->event)
+    {
+        Event_Post(transfer->event, (uint32_t)transfer);    // Handled from the event loop
+    }
+}
+
+/**
+ * @brief  Address acknowledged in read direction: prepare ACK/POS/STOP for the transfer length
+ *         (RM0368 master receiver sequences for N = 1, N = 2 and N > 2).
+ */
+static void I2C_ReceiveSetup(I2C_TypeDef* I2Cx, uint16_t length)
+{
+    if (length == 1)
+    {
+        I2Cx->CR1 &= ~I2C_CR1_ACK;                  // NACK the only byte
+        (void)I2Cx->SR2;                            // Clear ADDR
+        I2Cx->CR1 |= I2C_CR1_STOP;                  // STOP after the byte
+    }
+    else if (length == 2)
+    {
+        I2Cx->CR1 &= ~I2C_CR1_ACK;
+        I2Cx->CR1 |= I2C_CR1_POS;                   // NACK applies to the second byte
+        (void)I2Cx->SR2;
+        I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;              // Wait for BTF (both bytes received)
+    }
+    else
+    {
+        I2Cx->CR1 |= I2C_CR1_ACK;
+        (void)I2Cx->SR2;
+        if (length == 3)
+        {
+            I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;          // Last three bytes handled on BTF
+        }
+    }
+}
+
+/**
+ * @brief  Common event interrupt handler of the master state machine.
+ */
+static void I2C_EV_Handler(I2C_TypeDef* I2Cx)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    I2C_Transfer_Typedef* transfer = ctx->transfer;
+    uint32_t sr1 = I2Cx->SR1;
+
+    ctx->stats.interrupts++;
+
+    if (transfer == 0)
+    {
+        if (ctx->slave)
+            I2C_Slave_EV_Handler(I2Cx, ctx, sr1);
+        else
+            I2Cx->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);    // Spurious event
+        return;
+    }
+
+    // START (or repeated START) sent: send address with direction
+    if (sr1 & I2C_SR1_SB)
+    {
+        uint8_t read = (ctx->state == I2C_STATE_RX) || (transfer->txLength == 0 && transfer->rxLength);
+        ctx->state = read ? I2C_STATE_RX : I2C_STATE_TX;
+        ctx->index = 0;
+        if (!(transfer->address & I2C_ADDR_10BIT))
+        {
+            I2Cx->DR = ((transfer->address & 0x7F) << 1) | read;
+        }
+        else if (read && ctx->header10)
+        {
+            I2Cx->DR = I2C_HEADER_10BIT(transfer->address) | 1;    // Slave already addressed: header only
+            ctx->header10 = 2;
+        }
+        else
+        {
+            I2Cx->DR = I2C_HEADER_10BIT(transfer->address);        // Header in write form, ADD10 follows
+        }
+        return;
+    }
+
+    // 10-bit header acknowledged: send the low address byte
+    if (sr1 & I2C_SR1_ADD10)
+    {
+        I2Cx->DR = transfer->address & 0xFF;
+        ctx->header10 = 1;
+        return;
+    }
+
+    // Address acknowledged
+    if (sr1 & I2C_SR1_ADDR)
+    {
+        const I2C_DMA_Typedef* dma = &i2cDMA[I2C_Index(I2Cx)];
+
+        if (ctx->state == I2C_STATE_RX && ctx->header10 == 1)
+        {
+            (void)I2Cx->SR2;                        // 10-bit read: address sent in write form,
+            I2Cx->CR1 |= I2C_CR1_START;             // repeated START for the read header
+            return;
+        }
+
+        if (ctx->state == I2C_STATE_RX)
+        {
+            if (ctx->dma && transfer->rxLength > 1)
+            {
+                DMA_Start(dma->rxStream, &I2Cx->DR, transfer->rxData, transfer->rxLength);
+                I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;
+                I2Cx->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;  // Hardware NACKs the last byte
+                I2Cx->CR1 |= I2C_CR1_ACK;
+                (void)I2Cx->SR2;                    // Clear ADDR, DMA takes over
+            }
+            else
+            {
+                I2C_ReceiveSetup(I2Cx, transfer->rxLength);
+            }
+        }
+        else
+        {
+            if (ctx->dma && transfer->txLength)
+            {
+                DMA_Start(dma->txStream, &I2Cx->DR, transfer->txData, transfer->txLength);
+                ctx->index = transfer->txLength;    // All queued: next event is BTF after the last byte
+                I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;
+                I2Cx->CR2 |= I2C_CR2_DMAEN;
+            }
+            (void)I2Cx->SR2;                        // Clear ADDR
+            if (transfer->txLength == 0)
+            {
+                I2Cx->CR1 |= I2C_CR1_STOP;          // Address only (probe)
+                I2C_Complete(I2Cx, ctx, I2C_OK);
+            }
+        }
+        return;
+    }
+
+    if (ctx->state == I2C_STATE_TX)
+    {
+        if ((sr1 & I2C_SR1_BTF) && ctx->index >= transfer->txLength)
+        {
+            if (transfer->rxLength)
+            {
+                ctx->state = I2C_STATE_RX;
+                I2Cx->CR2 &= ~I2C_CR2_DMAEN;
+                I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+                I2Cx->CR1 |= I2C_CR1_START;         // Repeated START for the read phase
+            }
+            else
+            {
+                I2Cx->CR1 |= I2C_CR1_STOP;
+                I2C_Complete(I2Cx, ctx, I2C_OK);
+            }
+        }
+        else if (sr1 & I2C_SR1_TXE)
+        {
+            if (ctx->index < transfer->txLength)
+            {
+                I2Cx->DR = transfer->txData[ctx->index++];
+            }
+            else
+            {
+                I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;      // Last byte in shift register, wait for BTF
+            }
+        }
+        return;
+    }
+
+    if (ctx->state == I2C_STATE_RX)
+    {
+        uint16_t remaining = transfer->rxLength - ctx->index;
+
+        if ((sr1 & I2C_SR1_BTF) && remaining <= 3)
+        {
+            if (remaining == 3)
+            {
+                I2Cx->CR1 &= ~I2C_CR1_ACK;          // NACK the last byte
+                transfer->rxData[ctx->index++] = I2Cx->DR;
+            }
+            else if (remaining == 2)
+            {
+                I2Cx->CR1 |= I2C_CR1_STOP;          // Both bytes received, bus held by clock stretch
+                transfer->rxData[ctx->index++] = I2Cx->DR;
+                transfer->rxData[ctx->index++] = I2Cx->DR;
+                I2C_Complete(I2Cx, ctx, I2C_OK);
+            }
+        }
+        else if ((sr1 & I2C_SR1_RXNE) && (remaining > 3 || transfer->rxLength == 1))
+        {
+            transfer->rxData[ctx->index++] = I2Cx->DR;
+            if (remaining == 1)
+            {
+                I2C_Complete(I2Cx, ctx, I2C_OK);    // Single byte read, STOP already requested
+            }
+            else if (remaining == 4)
+            {
+                I2Cx->CR2 &= ~I2C_CR2_ITBUFEN;      // Last three bytes handled on BTF
+            }
+        }
+    }
+}
+
+/**
+ * @brief  Common error interrupt handler: abort the transfer and report the cause.
+ */
+static void I2C_ER_Handler(I2C_TypeDef* I2Cx)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    uint32_t sr1 = I2Cx->SR1;
+    uint8_t status;
+
+    ctx->stats.interrupts++;
+
+    if (ctx->transfer == 0 && ctx->slave)
+    {
+        // Slave: NACK from the master is the normal end of a remote read
+        I2Cx->SR1 = ~I2C_SR1_ERRORS & 0xFFFF;
+        I2C_Slave_End(I2Cx, ctx);
+        return;
+    }
+
+    status = I2C_ErrorStatus(I2Cx, sr1);
+    if (ctx->transfer && status == I2C_ERROR_ARLO)
+    {
+        ctx->stats.collisions++;
+        TRACE(TRACE_I2C1 + I2C_Index(I2Cx), TRACE_ERROR, status);
+        if (ctx->retries < I2C_ARLO_RETRIES)
+        {
+            // Hardware is in slave mode and the bus released; the new START is
+            // held back until the winning master sends its STOP
+            ctx->retries++;
+            I2Cx->CR2 &= ~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+            I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+            I2Cx->CR1 &= ~I2C_CR1_POS;
+            if (ctx->dma)
+            {
+                DMA_Stop(i2cDMA[I2C_Index(I2Cx)].txStream);
+                DMA_Stop(i2cDMA[I2C_Index(I2Cx)].rxStream);
+            }
+            ctx->index = 0;
+            ctx->header10 = 0;
+            ctx->state = I2C_STATE_START;
+            I2Cx->CR1 |= I2C_CR1_START;
+            return;
+        }
+    }
+    if (ctx->transfer)
+    {
+        I2C_Complete(I2Cx, ctx, (status == I2C_OK) ? I2C_ERROR_BERR : status);
+    }
+}
+
+/**
+ * @brief  DMA receive complete: all bytes stored, last one NACKed by hardware; send STOP.
+ */
+static void I2C_DMA_RX_Handler(I2C_TypeDef* I2Cx)
+{
+    I2C_Context_Typedef* ctx = I2C_GetContext(I2Cx);
+    DMA_Stream_TypeDef* stream = i2cDMA[I2C_Index(I2Cx)].rxStream;
+    uint8_t flags = DMA_GetFlags(stream);
+
+    DMA_ClearFlags(stream, flags);
+    ctx->stats.interrupts++;
+
+    if (ctx->transfer && ctx->dma && ctx->state == I2C_STATE_RX)
+    {
+        I2Cx->CR1 |= I2C_CR1_STOP;
+        I2C_Complete(I2Cx, ctx, (flags & DMA_FLAG_TE) ? I2C_ERROR_OVR : I2C_OK);
+    }
+}
+
+/************************************** I2C Interrupt Handlers **************************************/
+#if I2C1_INTERRUPT_ENABLE
+void I2C1_EV_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_EV_Handler(I2C1);
+    PROFILE_ISR_EXIT(PROFILE_I2C1_EV);
+}
+
+void I2C1_ER_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_ER_Handler(I2C1);
+    PROFILE_ISR_EXIT(PROFILE_I2C1_ER);
+}
+#endif
+
+#if I2C2_INTERRUPT_ENABLE
+void I2C2_EV_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_EV_Handler(I2C2);
+    PROFILE_ISR_EXIT(PROFILE_I2C2_EV);
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_ER_Handler(I2C2);
+    PROFILE_ISR_EXIT(PROFILE_I2C2_ER);
+}
+#endif
+
+#if I2C3_INTERRUPT_ENABLE
+void I2C3_EV_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_EV_Handler(I2C3);
+    PROFILE_ISR_EXIT(PROFILE_I2C3_EV);
+}
+
+void I2C3_ER_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_ER_Handler(I2C3);
+    PROFILE_ISR_EXIT(PROFILE_I2C3_ER);
+}
+#endif
+
+#if I2C1_DMA_ENABLE
+void DMA1_Stream0_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_DMA_RX_Handler(I2C1);
+    PROFILE_ISR_EXIT(PROFILE_I2C1_DMA);
+}
+#endif
+
+#if I2C2_DMA_ENABLE
+void DMA1_Stream3_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_DMA_RX_Handler(I2C2);
+    PROFILE_ISR_EXIT(PROFILE_I2C2_DMA);
+}
+#endif
+
+#if I2C3_DMA_ENABLE
+void DMA1_Stream2_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2C_DMA_RX_Handler(I2C3);
+    PROFILE_ISR_EXIT(PROFILE_I2C3_DMA);
 }
+#endif
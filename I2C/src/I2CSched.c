@@ -0,0 +1,165 @@
+#include <string.h>
+#include "I2CSched.h"
+
+/**
+ * @brief  Scheduler clock in milliseconds, from the 64-bit microsecond time base.
+ */
+static void I2CSched_UpdateTime(I2CSched_Typedef* sched)
+{
+    sched->nowMs = (uint32_t)(Time_now_us64() / 1000);
+}
+
+/**
+ * @brief  Starts the earliest due job left in the batch and moves its due time to the next
+ *         period. Runs from the main loop for the first job of a batch and from the completion
+ *         interrupt for the others (I2C_Transfer_IT waits there for the previous STOP).
+ */
+static void I2CSched_StartNext(I2CSched_Typedef* sched)
+{
+    int8_t next = -1;
+
+    for (uint8_t i = 0; i < sched->jobCount; i++)
+    {
+        if ((sched->batch & (1UL << i))
+            && (next < 0 || (int32_t)(sched->jobs[i].due - sched->jobs[next].due) < 0))
+        {
+            next = i;
+        }
+    }
+    if (next < 0)
+    {
+        return;
+    }
+
+    I2CSched_Job_Typedef* job = &sched->jobs[next];
+
+    sched->current = next;
+    sched->transfer.address = job->address;
+    sched->transfer.txData = &job->reg;             // Register pointer, then repeated START
+    sched->transfer.txLength = 1;
+    sched->transfer.rxData = job->buffer[!job->front];  // Back buffer, published on completion
+    sched->transfer.rxLength = job->length;
+
+    if (I2C_Transfer_IT(sched->I2Cx, &sched->transfer) == I2C_OK)
+    {
+        sched->batch &= ~(1UL << next);
+        job->due += job->periodMs;                  // Next period, once this one is ordered and started
+        if ((int32_t)(job->due - sched->nowMs) <= 0)
+        {
+            job->due = sched->nowMs + job->periodMs;    // Fell behind: skip missed periods
+        }
+    }
+    // else: bus taken by another transfer, I2CSched_Poll retries
+}
+
+/**
+ * @brief  Transfer completion (interrupt): publishes the snapshot and chains the next job
+ *         so the bus does not go idle between the reads of a batch.
+ */
+static void I2CSched_Done(I2C_Transfer_Typedef* transfer)
+{
+    I2CSched_Typedef* sched = transfer->context;
+    I2CSched_Job_Typedef* job = &sched->jobs[sched->current];
+
+    if (transfer->status == I2C_OK)
+    {
+        job->front = !job->front;                   // Back buffer becomes the snapshot
+        job->sequence++;
+    }
+    else
+    {
+        job->errorCount++;
+    }
+    sched->readCount++;
+
+    if (sched->batch)
+    {
+        I2CSched_StartNext(sched);
+    }
+}
+
+/************************************** Setup scheduler ***************************************
+ * @brief  Prepares the job table: every job is due immediately.
+ *
+ * @param  sched: Pointer to scheduler (I2Cx, jobs and jobCount filled in, I2C_Init called)
+ */
+void I2CSched_init(I2CSched_Typedef* sched)
+{
+    I2CSched_UpdateTime(sched);
+    sched->batch = 0;
+    sched->batchCount = 0;
+    sched->readCount = 0;
+
+    sched->transfer = (I2C_Transfer_Typedef){ .callback = I2CSched_Done, .context = sched };
+    sched->transfer.status = I2C_OK;
+
+    for (uint8_t i = 0; i < sched->jobCount; i++)
+    {
+        sched->jobs[i].due = sched->nowMs;
+        sched->jobs[i].front = 0;
+        sched->jobs[i].sequence = 0;
+        sched->jobs[i].errorCount = 0;
+    }
+}
+
+/**************************************** Run jobs ********************************************
+ * @brief  Called from the main loop. Once the previous batch has finished, every job due now
+ *         (or within I2CSCHED_LOOKAHEAD_MS) is gathered into a batch that runs back-to-back in
+ *         earliest-deadline order, each read chained from the completion of the previous one.
+ *         Gathering nearby deadlines trades a little jitter for far fewer idle gaps on the bus.
+ *
+ * @param  sched: Pointer to scheduler
+ */
+void I2CSched_Poll(I2CSched_Typedef* sched)
+{
+    I2CSched_UpdateTime(sched);
+
+    if (sched->transfer.status == I2C_BUSY)
+    {
+        return;                                     // Batch still running
+    }
+    if (sched->batch)
+    {
+        I2CSched_StartNext(sched);                  // Resume after the bus was taken
+        return;
+    }
+
+    uint32_t batch = 0;
+    for (uint8_t i = 0; i < sched->jobCount; i++)
+    {
+        I2CSched_Job_Typedef* job = &sched->jobs[i];
+
+        if ((int32_t)(job->due - sched->nowMs) <= I2CSCHED_LOOKAHEAD_MS)
+        {
+            batch |= 1UL << i;                      // Due time advanced when the read starts
+        }
+    }
+
+    if (batch)
+    {
+        sched->batch = batch;
+        sched->batchCount++;
+        I2CSched_StartNext(sched);
+    }
+}
+
+/************************************** Read snapshot *****************************************
+ * @brief  Copies the latest published snapshot of a job without locking: the copy is retried
+ *         if a completion published a new snapshot while it was running.
+ *
+ * @param  job: Pointer to job
+ * @param  data: Destination (job->length bytes)
+ * @return Snapshot sequence number (0: no successful read yet)
+ */
+uint32_t I2CSched_Read(I2CSched_Job_Typedef* job, uint8_t* data)
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = job->sequence;
+        memcpy(data, job->buffer[job->front], job->length);
+    } while (sequence != job->sequence);
+
+    return sequence;
+}
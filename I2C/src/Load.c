@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include "Load.h"
+
+#if LOAD_ENABLE
+
+static Event_Timer_Typedef sampleTimer;
+static Load_Stats_Typedef stats;
+static uint8_t samples[LOAD_WINDOW];            // Last samples, oldest overwritten first
+static uint8_t sampleIndex;
+static uint32_t windowCycles;                   // Cycles of the last complete window
+
+static uint64_t lastTime;                       // Time and sleep time at the previous sample
+static uint64_t lastSleep;
+static uint32_t windowStartCycles;              // Cycle count at the start of the window
+
+static Load_Account_Typedef* accounts;
+#if PROFILE_ENABLE
+static uint64_t isrTotals[PROFILE_COUNT];       // Profile totals at the previous window
+static uint8_t isrPercent[PROFILE_COUNT];       // ISR shares of the last complete window
+#endif
+
+/**
+ * @brief  Share of total in percent, rounded.
+ */
+static uint8_t Load_Percent(uint64_t part, uint64_t total)
+{
+    if (!total)
+    {
+        return 0;
+    }
+    return (part >= total) ? 100 : (uint8_t)((part * 100 + total / 2) / total);
+}
+
+/**
+ * @brief  End of a window: converts the cycles charged to every account (and, with
+ *         PROFILE_ENABLE, to every profiled ISR) into its share of the window.
+ */
+static void Load_Attribute(void)
+{
+    for (Load_Account_Typedef* account = accounts; account; account = account->next)
+    {
+        __disable_irq();                        // ISR accounts may be charging
+        uint32_t cycles = account->cycles;
+        account->cycles = 0;
+        __enable_irq();
+
+        account->percent = Load_Percent(cycles, windowCycles);
+    }
+
+    #if PROFILE_ENABLE
+    for (uint8_t i = 0; i < PROFILE_LATENCY; i++)
+    {
+        __disable_irq();
+        uint64_t total = Profile_Get(i)->total;
+        __enable_irq();
+
+        uint64_t cycles = (total >= isrTotals[i]) ? total - isrTotals[i] : total;  // Profile_Reset
+        isrTotals[i] = total;
+        isrPercent[i] = Load_Percent(cycles, windowCycles);
+    }
+    #endif
+}
+
+/**
+ * @brief  Sample timer: load is the share of the sample period not spent asleep. Interrupts
+ *         that end a WFI are served outside the sleep accounting, so ISR time counts as load.
+ */
+static void Load_Sample(uint32_t arg)
+{
+    uint64_t now = Time_now_us64();
+    uint64_t asleep = Time_sleepTotal_us();
+    uint32_t cycles = DWT->CYCCNT;
+    uint8_t load = 100 - Load_Percent(asleep - lastSleep, now - lastTime);
+    uint32_t sum = 0;
+
+    lastTime = now;
+    lastSleep = asleep;
+
+    samples[sampleIndex] = load;
+    if (++sampleIndex == LOAD_WINDOW)
+    {
+        sampleIndex = 0;
+        windowCycles = cycles - windowStartCycles;  // Wraps after 51 s at 84 MHz
+        windowStartCycles = cycles;
+        Load_Attribute();
+    }
+
+    stats.samples++;
+    stats.current = load;
+    if (load > stats.peak)
+    {
+        stats.peak = load;
+    }
+
+    uint8_t count = (stats.samples < LOAD_WINDOW) ? stats.samples : LOAD_WINDOW;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        sum += samples[i];
+    }
+    stats.average = sum / count;
+}
+
+/*************************************** Setup monitor ****************************************
+ * @brief  Starts the DWT cycle counter (used by the accounts) and the sample timer. The load
+ *         averages the last LOAD_WINDOW samples, a sliding window of
+ *         LOAD_WINDOW * LOAD_SAMPLE_US; the peak keeps the busiest single sample.
+ * @note   Only time spent in Time_sleepUntil counts as idle, so the application must sleep
+ *         through Event_Run or Time_sleepUntil; busy-wait delays (Delay_us) count as load.
+ */
+void Load_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // Enable DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // Start cycle counter
+
+    Load_Reset();
+
+    sampleTimer.callback = Load_Sample;
+    Event_TimerStart(&sampleTimer, LOAD_SAMPLE_US, LOAD_SAMPLE_US);
+}
+
+/**
+ * @brief  Adds an account to the attribution; its share is updated once per window.
+ *
+ * @param  account: Pointer to account (name filled in, must stay valid)
+ */
+void Load_Register(Load_Account_Typedef* account)
+{
+    account->cycles = 0;
+    account->percent = 0;
+    account->next = accounts;
+    accounts = account;
+}
+
+/**
+ * @brief  Returns the load figures.
+ */
+Load_Stats_Typedef* Load_GetStats(void)
+{
+    return &stats;
+}
+
+/**
+ * @brief  Clears the samples and the peak and starts a new window.
+ */
+void Load_Reset(void)
+{
+    stats = (Load_Stats_Typedef){ 0 };
+    sampleIndex = 0;
+    lastTime = Time_now_us64();
+    lastSleep = Time_sleepTotal_us();
+    windowStartCycles = DWT->CYCCNT;
+}
+
+/************************************** Console dump ******************************************
+ * @brief  Prints the load, then the share of every account and profiled ISR that used time
+ *         in the last complete window, e.g. "Load 37% peak 82%", "  sensor 12%",
+ *         "  ISR I2C1 EV 3%".
+ *
+ * @param  print: Line output, e.g. Log_s
+ */
+void Load_Dump(void (*print)(char* line))
+{
+    char line[48];
+
+    snprintf(line, sizeof(line), "Load %u%% peak %u%%", stats.average, stats.peak);
+    print(line);
+
+    for (Load_Account_Typedef* account = accounts; account; account = account->next)
+    {
+        snprintf(line, sizeof(line), "  %s %u%%", account->name, account->percent);
+        print(line);
+    }
+
+    #if PROFILE_ENABLE
+    for (uint8_t i = 0; i < PROFILE_LATENCY; i++)
+    {
+        if (isrPercent[i])
+        {
+            snprintf(line, sizeof(line), "  ISR %s %u%%", Profile_Name(i), isrPercent[i]);
+            print(line);
+        }
+    }
+    #endif
+}
+
+#endif
@@ -1,5 +1,30 @@
 #include "Log.h"
 
+#if LOG_ITM
+static uint32_t dropped;                    // Text bytes lost to a full stimulus port FIFO
+
+/*************************************** ITM write *********************************************
+ * @brief  Writes one byte to a stimulus port. A port reads non-zero while its FIFO entry is
+ *         free; text gives up at once and the byte is dropped, binary data waits for the entry
+ *         (a dump with holes cannot be decoded). Nothing is written while ITM or the port is off.
+ */
+static void Log_ITM_Write(uint8_t port, uint8_t data, uint8_t wait)
+{
+    if (!(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & (1UL << port)))
+        return;
+
+    while (!ITM->PORT[port].u32)
+    {
+        if (!wait)
+        {
+            dropped++;
+            return;
+        }
+    }
+    ITM->PORT[port].u8 = data;
+}
+#endif
+
 /************************************** Display integer *****************************************/
 void Log_i(uint32_t data_Tx)
 {
@@ -31,15 +56,69 @@ void Log_s(char* data_Tx)
 /*************************************** Display char ******************************************/
 void Log_c(uint8_t Tx_data)
 {
+#if LOG_ITM
+    Log_ITM_Write(LOG_ITM_TEXT_PORT, Tx_data, 0);
+#else
     while (!(USART1->SR & USART_SR_TXE));
 
     USART1->DR = Tx_data;
+#endif
 }
 
+/*************************************** Binary byte *******************************************/
+void Log_b(uint8_t data_Tx)
+{
+#if LOG_ITM
+    Log_ITM_Write(LOG_ITM_DATA_PORT, data_Tx, 1);
+#else
+    Log_c(data_Tx);
+#endif
+}
+
+/*************************************** Dropped bytes *****************************************/
+uint32_t Log_Dropped(void)
+{
+#if LOG_ITM
+    return dropped;
+#else
+    return 0;                               // USART1 output blocks instead
+#endif
+}
+
+/*************************************** Reclock ***********************************************/
+static void Log_Reclock(uint8_t event)
+{
+#if LOG_ITM
+    if (event == CLOCK_PRE_CHANGE)
+        while (ITM->TCR & ITM_TCR_BUSY_Msk);                // queued packets leave at the old rate
+    else
+        TPI->ACPR = (Clock_GetHCLK() / LOG_SWO_BAUD) - 1;   // same SWO rate from the new HCLK
+#else
+    if (event == CLOCK_PRE_CHANGE)
+        while (!(USART1->SR & USART_SR_TC));                // last char leaves at the old rate
+    else
+        USART1->BRR = (Clock_GetPCLK2() + 4800) / 9600;     // same 9600 baud from the new clock
+#endif
+}
 
 /*************************************** Initialize *******************************************/
 void Log_init()
 {
+#if LOG_ITM
+    // SWO is PB3 in its reset state (AF0, TRACESWO); USART1 stays free for the application
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // enable ITM and TPIU
+    DBGMCU->CR |= DBGMCU_CR_TRACE_IOEN;                 // trace pin on, asynchronous mode
+
+    TPI->SPPR = 2;                                      // SWO with NRZ (UART) encoding
+    TPI->ACPR = (Clock_GetHCLK() / LOG_SWO_BAUD) - 1;   // SWO bit rate from HCLK
+    TPI->FFCR = TPI_FFCR_TrigIn_Msk;                    // formatter off: ITM packets only
+
+    ITM->LAR = 0xC5ACCE55;                              // unlock ITM registers
+    ITM->TCR = ITM_TCR_ITMENA_Msk | ITM_TCR_SYNCENA_Msk | (1UL << ITM_TCR_TraceBusID_Pos);
+    ITM->TPR = 0;                                       // ports writable without privilege
+    ITM->TER = (1UL << LOG_ITM_TEXT_PORT) | (1UL << LOG_ITM_DATA_PORT);
+    Clock_Register(Log_Reclock);
+#else
     RCC->AHB1ENR |= 1;                      // enable gpio port A clock
 
     GPIOA->MODER |= (0xA << 18);            // mode as alternate function 
@@ -59,8 +138,10 @@ void Log_init()
     USART1->CR2 |= 0x00003000;              // 1 stop bit
 
     // Baud rate
-    USART1->BRR = (PERIPHERAL_CLK/9600) + 1;
+    USART1->BRR = (Clock_GetPCLK2() + 4800) / 9600;    // 9600 baud from the APB2 clock
+    Clock_Register(Log_Reclock);
 
     // Configure UART mode
     USART1->CR1 |= 0x00000008;              // enable Tx
+#endif
 }
\ No newline at end of file
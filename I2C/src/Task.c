@@ -0,0 +1,155 @@
+#include "Task.h"
+
+static Task_Typedef* tasks;                     // Running tasks, most recently started first
+static Event_Timer_Typedef wakeTimer;           // Shared by every TASK_DELAY_US
+
+/**
+ * @brief  Removes a task from the running list.
+ */
+static void Task_Unlink(Task_Typedef* task)
+{
+    for (Task_Typedef** link = &tasks; *link; link = &(*link)->next)
+    {
+        if (*link == task)
+        {
+            *link = task->next;
+            break;
+        }
+    }
+    task->running = 0;
+    task->sleeping = 0;
+}
+
+/**
+ * @brief  Runs a task up to its next wait. A finished task leaves the list and signals the
+ *         others, so a task can await another one (TASK_AWAIT(task, !child.running)).
+ */
+static void Task_Run(Task_Typedef* task)
+{
+    #if LOAD_ENABLE
+    LOAD_BEGIN();
+    uint8_t status = task->function(task);
+    if (task->load)
+    {
+        LOAD_END(task->load);
+    }
+    #else
+    uint8_t status = task->function(task);
+    #endif
+
+    if (status == TASK_DONE)
+    {
+        Task_Unlink(task);
+        Event_Post(Task_Signal, 0);
+    }
+}
+
+/**
+ * @brief  Arms the shared timer for the earliest TASK_DELAY_US deadline.
+ */
+static void Task_ArmTimer(void)
+{
+    int32_t next = INT32_MAX;
+
+    for (Task_Typedef* task = tasks; task; task = task->next)
+    {
+        if (task->sleeping)
+        {
+            int32_t left = (int32_t)(task->wakeAt - Time_now_us());
+            if (left < next)
+            {
+                next = (left > 0) ? left : 0;
+            }
+        }
+    }
+
+    if (next == INT32_MAX)
+    {
+        Event_TimerStop(&wakeTimer);
+    }
+    else
+    {
+        Event_TimerStart(&wakeTimer, next, 0);
+    }
+}
+
+/**
+ * @brief  Shared timer expired: sleeping tasks check their deadlines.
+ */
+static void Task_Wake(uint32_t arg)
+{
+    Task_Signal(0);
+    Task_ArmTimer();
+}
+
+/************************************** Start/stop task ***************************************
+ * @brief  Starts a task from its first line; it runs from the event loop. Restarting a running
+ *         task begins it again. Stopping unlinks it wherever it waits.
+ *
+ * @param  task: Pointer to task state (must stay valid while running)
+ * @param  function: Task body (TASK_BEGIN ... TASK_END)
+ * @param  context: Stored in task->context
+ * @note   Event loop context only (handlers, timer callbacks, tasks).
+ */
+void Task_Start(Task_Typedef* task, Task_Function function, void* context)
+{
+    task->function = function;
+    task->context = context;
+    task->line = 0;
+    task->sleeping = 0;
+    if (!task->running)
+    {
+        task->next = tasks;
+        tasks = task;
+        task->running = 1;
+    }
+
+    wakeTimer.callback = Task_Wake;
+    Event_Post(Task_Resume, (uint32_t)task);
+}
+
+void Task_Stop(Task_Typedef* task)
+{
+    if (task->running)
+    {
+        Task_Unlink(task);
+        Task_ArmTimer();
+    }
+}
+
+/*************************************** Wake tasks *******************************************
+ * @brief  Task_Signal runs every task so each re-checks what it awaits. Use it as the event of
+ *         driver completions (I2C transfer event, register map writeEvent, SPI frameEvent,
+ *         UART_SetRxEvent). Task_Resume runs one task (arg: the task).
+ *
+ * @param  arg: Event argument (unused by Task_Signal)
+ */
+void Task_Signal(uint32_t arg)
+{
+    Task_Typedef* task = tasks;
+
+    while (task)
+    {
+        Task_Typedef* next = task->next;            // The task may finish and unlink itself
+        Task_Run(task);
+        task = next;
+    }
+}
+
+void Task_Resume(uint32_t task)
+{
+    if (((Task_Typedef*)task)->running)
+    {
+        Task_Run((Task_Typedef*)task);
+    }
+}
+
+/**
+ * @brief  Sets the TASK_DELAY_US deadline of a task and rearms the shared timer.
+ */
+void Task_Sleep(Task_Typedef* task, uint32_t us)
+{
+    task->wakeAt = Time_deadline_us(us);
+    task->sleeping = 1;
+    Task_ArmTimer();
+}
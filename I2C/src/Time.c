@@ -0,0 +1,252 @@
+#include "Time.h"
+
+static volatile uint32_t overflows;             // Upper 32 bits of the 64-bit time
+static void (*alarms[TIME_ALARM_COUNT])(void);  // Callbacks of the armed alarms
+
+#if TIME_SLEEP_STATS
+static uint64_t sleepTime;                      // Microseconds spent in WFI since Time_init
+static uint64_t sleepReported;                  // sleepTime at the last Time_sleepPercent
+static uint64_t windowStart;                    // Start of the reporting window
+#endif
+
+/**
+ * @brief  Reclock notification: reloads the prescaler so the count rate stays 1 MHz. The count
+ *         is carried over; the restarted prescaler costs at most one microsecond.
+ */
+static void Time_Reclock(uint8_t event)
+{
+    if (event == CLOCK_POST_CHANGE)
+    {
+        uint32_t count = TIM5->CNT;
+
+        TIM5->PSC = (Clock_GetTimerClock1() / 1000000) - 1;
+        TIM5->CR1 |= TIM_CR1_URS;                   // The UG below must not count as a wrap
+        TIM5->EGR = TIM_EGR_UG;                     // Load the prescaler now (clears CNT)
+        TIM5->CNT = count;
+        TIM5->CR1 &= ~TIM_CR1_URS;
+    }
+}
+
+/************************************** Setup time base ***************************************
+ * @brief  Starts TIM5 as a free running 32-bit microsecond counter. It is never reset or
+ *         reloaded by its users, so any code (main loop or interrupt) can read it at any time.
+ *         The update interrupt extends it to 64 bits.
+ */
+void Time_init(void)
+{
+    RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;             // Enable TIM5 clock
+
+    TIM5->CR1 = 0;
+    TIM5->PSC = (Clock_GetTimerClock1() / 1000000) - 1; // 1 MHz count rate from the APB1 timer clock
+    TIM5->ARR = 0xFFFFFFFF;                         // Full 32-bit range
+    TIM5->CNT = 0;
+    TIM5->EGR = TIM_EGR_UG;                         // Load the prescaler
+    TIM5->SR = 0;
+    TIM5->DIER = TIM_DIER_UIE;                      // Count wraps (every 71.6 minutes)
+
+    overflows = 0;
+    #if TIME_SLEEP_STATS
+    sleepTime = 0;
+    sleepReported = 0;
+    windowStart = 0;
+    #endif
+    NVIC_EnableIRQ(TIM5_IRQn);
+    Clock_Register(Time_Reclock);                   // Keep 1 MHz across operating points
+
+    TIM5->CR1 = TIM_CR1_CEN;                        // Enable counter
+}
+
+/************************************** Current time ******************************************
+ * @brief  Microseconds since Time_init. The 32-bit value wraps every 71.6 minutes, which is
+ *         harmless for the elapsed/deadline helpers below; use the 64-bit value for timestamps.
+ * @note   Time_now_us64 misses a wrap that happens while interrupts are masked.
+ */
+uint32_t Time_now_us(void)
+{
+    return TIM5->CNT;
+}
+
+uint64_t Time_now_us64(void)
+{
+    uint32_t high, low;
+
+    do
+    {
+        high = overflows;
+        low = TIM5->CNT;
+    } while (high != overflows);                    // Wrapped in between: read again
+
+    return ((uint64_t)high << 32) | low;
+}
+
+/*********************************** Elapsed and deadlines ************************************
+ * @brief  Interval arithmetic on the wrapping 32-bit time. Deadlines must lie within
+ *         35 minutes of the current time.
+ *
+ * @param  since: Earlier Time_now_us value
+ * @param  us: Interval from now
+ * @param  deadline: Value returned by Time_deadline_us
+ */
+uint32_t Time_elapsed_us(uint32_t since)
+{
+    return TIM5->CNT - since;
+}
+
+uint32_t Time_deadline_us(uint32_t us)
+{
+    return TIM5->CNT + us;
+}
+
+uint8_t Time_expired(uint32_t deadline)
+{
+    return (int32_t)(TIM5->CNT - deadline) >= 0;
+}
+
+/************************************** Sleeping wait *****************************************
+ * @brief  Sleeps (WFI) until the deadline instead of spinning. Channel 1 of TIM5 compares
+ *         against the deadline and wakes the core; any other interrupt wakes it as well, gets
+ *         served, and the core goes back to sleep while the deadline is still ahead.
+ *
+ *         Time_sleepUntilWake also returns as soon as wake() reports pending work, e.g. an
+ *         event posted by the interrupt that woke the core.
+ *
+ * @param  deadline: Value returned by Time_deadline_us (within 35 minutes)
+ * @param  wake: Condition checked after every wake-up (NULL: deadline only)
+ * @note   The checks and WFI run with interrupts masked, so a wake-up cannot be lost between
+ *         them: a pending interrupt still ends WFI and is served once unmasked.
+ * @note   Sleeps in thread mode only. CCR1/CC1IE are a single wake source, and an interrupt
+ *         at or below TIM5 priority could not be woken by it, so from an interrupt the wait
+ *         spins instead and leaves the wake source of the interrupted sleep alone.
+ */
+void Time_sleepUntil(uint32_t deadline)
+{
+    Time_sleepUntilWake(deadline, 0);
+}
+
+void Time_sleepUntilWake(uint32_t deadline, uint8_t (*wake)(void))
+{
+    if (__get_IPSR() != 0)
+    {
+        while (!Time_expired(deadline) && !(wake && wake()));  // Interrupt context: spin
+        return;
+    }
+
+    TIM5->CCR1 = deadline;
+    TIM5->SR = (uint32_t)~TIM_SR_CC1IF;             // rc_w0: writing 1 leaves the other flags alone
+    __disable_irq();                                // DIER is shared with the alarm interrupt
+    TIM5->DIER |= TIM_DIER_CC1IE;                   // Compare match wakes the core
+    __enable_irq();
+
+    while (1)
+    {
+        __disable_irq();
+        if (Time_expired(deadline) || (wake && wake()))
+        {
+            __enable_irq();
+            break;
+        }
+        #if TIME_SLEEP_STATS
+        uint32_t start = TIM5->CNT;
+        __WFI();
+        sleepTime += TIM5->CNT - start;             // Asleep until the wake-up, ISR time excluded
+        #else
+        __WFI();
+        #endif
+        __enable_irq();                             // Serve whatever woke us
+    }
+
+    __disable_irq();
+    TIM5->DIER &= ~TIM_DIER_CC1IE;
+    __enable_irq();
+}
+
+#if TIME_SLEEP_STATS
+/**
+ * @brief  Percentage of time spent asleep in Time_sleepUntil since the previous call
+ *         (or since Time_init), a direct measure of the idle power savings.
+ */
+uint8_t Time_sleepPercent(void)
+{
+    __disable_irq();
+    uint64_t now = Time_now_us64();
+    uint64_t window = now - windowStart;
+    uint64_t asleep = sleepTime - sleepReported;
+    sleepReported = sleepTime;
+    windowStart = now;
+    __enable_irq();
+
+    return window ? (uint8_t)((asleep * 100) / window) : 0;
+}
+
+/**
+ * @brief  Microseconds spent asleep in Time_sleepUntil since Time_init (never reset, so
+ *         several users can take their own differences, e.g. the Load monitor).
+ * @note   Event loop context: the sleep loop is the only writer.
+ */
+uint64_t Time_sleepTotal_us(void)
+{
+    return sleepTime;
+}
+#endif
+
+/****************************************** Alarms ********************************************
+ * @brief  Calls callback from the TIM5 interrupt once the deadline is reached. Each slot holds
+ *         one alarm; arming it again replaces the deadline and callback. A deadline already
+ *         passed fires at once, so no alarm is lost to a late arming. Safe from any context.
+ *
+ * @param  alarm: TIME_ALARM_CH2 ... TIME_ALARM_CH4
+ * @param  deadline: Value returned by Time_deadline_us (within 35 minutes)
+ * @param  callback: Runs in interrupt context, may arm the slot again
+ */
+void Time_alarm(uint8_t alarm, uint32_t deadline, void (*callback)(void))
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    alarms[alarm] = callback;
+    (&TIM5->CCR2)[alarm] = deadline;
+    TIM5->SR = (uint32_t)~(TIM_SR_CC2IF << alarm);  // Drop a match of the previous deadline
+    TIM5->DIER |= TIM_DIER_CC2IE << alarm;
+    if (Time_expired(deadline))
+    {
+        TIM5->EGR = TIM_EGR_CC2G << alarm;          // Passed while arming: fire now
+    }
+    __set_PRIMASK(primask);
+}
+
+void Time_alarmCancel(uint8_t alarm)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    TIM5->DIER &= ~(TIM_DIER_CC2IE << alarm);
+    TIM5->SR = (uint32_t)~(TIM_SR_CC2IF << alarm);
+    __set_PRIMASK(primask);
+}
+
+/****************************************** ISR ***********************************************/
+void TIM5_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+
+    if (TIM5->SR & TIM_SR_UIF)
+    {
+        TIM5->SR = (uint32_t)~TIM_SR_UIF;           // Clear update flag only (rc_w0)
+        overflows++;
+    }
+    if (TIM5->SR & TIM_SR_CC1IF)
+    {
+        TIM5->SR = (uint32_t)~TIM_SR_CC1IF;         // Deadline reached, the core is awake now
+    }
+    for (uint8_t alarm = 0; alarm < TIME_ALARM_COUNT; alarm++)
+    {
+        if ((TIM5->DIER & (TIM_DIER_CC2IE << alarm)) && (TIM5->SR & (TIM_SR_CC2IF << alarm)))
+        {
+            TIM5->DIER &= ~(TIM_DIER_CC2IE << alarm);   // One shot
+            TIM5->SR = (uint32_t)~(TIM_SR_CC2IF << alarm);
+            alarms[alarm]();
+        }
+    }
+
+    PROFILE_ISR_EXIT(PROFILE_TIM5);
+}
@@ -0,0 +1,102 @@
+#include "Trace.h"
+#include "Clock.h"
+
+#if TRACE_ENABLE
+
+Trace_Buffer_Typedef traceBuffer;
+
+/**
+ * @brief  Reclock notification: records the new HCLK so the decoder converts the following
+ *         cycle stamps at the right rate.
+ */
+static void Trace_Reclock(uint8_t event)
+{
+    if (event == CLOCK_POST_CHANGE)
+    {
+        Trace_Record(TRACE_CLOCK, TRACE_RECLOCK, Clock_GetHCLK() / 1000000);
+    }
+}
+
+/**************************************** Setup trace *****************************************
+ * @brief  Starts the DWT cycle counter and recording. The buffer can be read at any time
+ *         through the debugger (e.g. gdb: dump binary value trace.bin traceBuffer) or sent with
+ *         Trace_Dump; tools/trace2chrome.py turns it into a Chrome trace timeline.
+ */
+void Trace_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // Enable DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // Start cycle counter
+
+    traceBuffer.magic = TRACE_MAGIC;
+    traceBuffer.size = TRACE_SIZE;
+    traceBuffer.clockHz = Clock_GetHCLK();
+    traceBuffer.next = 0;
+    traceBuffer.running = 1;
+    Clock_Register(Trace_Reclock);
+}
+
+/*************************************** Record event *****************************************
+ * @brief  Appends one record; safe from any context. About 20 cycles: the slot is claimed and
+ *         filled with interrupts masked, so records from nested interrupts never interleave.
+ *         Overwriting a TRACE_RECLOCK record moves its clock into the header, so clockHz is
+ *         always the clock of the oldest record in the buffer.
+ *
+ * @param  source: TRACE_USART1 ... TRACE_APP
+ * @param  event: TRACE_START ... TRACE_MARK
+ * @param  arg: Event argument
+ */
+void Trace_Record(uint8_t source, uint8_t event, uint16_t arg)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (traceBuffer.running)
+    {
+        Trace_Record_Typedef* record = &traceBuffer.records[traceBuffer.next++ % TRACE_SIZE];
+        if (record->event == TRACE_RECLOCK && traceBuffer.next > TRACE_SIZE)
+        {
+            traceBuffer.clockHz = record->arg * 1000000UL;  // Clock of the oldest record kept
+        }
+        record->cycles = DWT->CYCCNT;
+        record->event = event;
+        record->source = source;
+        record->arg = arg;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Trace_Freeze stops recording, e.g. from an error path, so the records leading up to
+ *         the failure are kept for post-mortem reading; Trace_Resume continues.
+ */
+void Trace_Freeze(void)
+{
+    traceBuffer.running = 0;
+}
+
+void Trace_Resume(void)
+{
+    traceBuffer.running = 1;
+}
+
+/**************************************** Dump trace ******************************************
+ * @brief  Sends the buffer image byte by byte (header, then the records in slot order) while
+ *         recording is held. Capture the output to a file and decode it on the host:
+ *         python3 tools/trace2chrome.py capture.bin trace.json
+ *
+ * @param  put: Byte output, e.g. Log_b
+ */
+void Trace_Dump(void (*put)(uint8_t byte))
+{
+    const uint8_t* image = (const uint8_t*)&traceBuffer;
+    uint16_t running = traceBuffer.running;
+
+    traceBuffer.running = 0;
+    for (uint32_t i = 0; i < sizeof(traceBuffer); i++)
+    {
+        put(image[i]);
+    }
+    traceBuffer.running = running;
+}
+
+#endif
@@ -1,46 +1,153 @@
+#include <string.h>
 #include "main.h"
 #include "I2C.h"
 
 #define I2C1_ADDRESS 0x30                       // I2C1 Master Address
 #define I2C2_ADDRESS 0x31                       // I2C2 Slave Address
-#define I2C_CLOCK_SPEED 100000                  // 100 kHz standard I2C speed
+#define I2C_CLOCK_SPEED 400000                  // 400 kHz fast mode I2C speed
 
 // I2C1: Master configuration
 I2C_Config_Typedef i2c1Config = {
     .clockSpeed = I2C_CLOCK_SPEED,
     .addressingMode = 0,                        // 7-bit addressing
-    .ownAddress = I2C1_ADDRESS
+    .ownAddress = I2C1_ADDRESS,
+    .dutyCycle = 0                              // Fast mode Tlow/Thigh = 2
 };
 
 // I2C2: Slave configuration
 I2C_Config_Typedef i2c2Config = {
     .clockSpeed = I2C_CLOCK_SPEED,
     .addressingMode = 0,                        // 7-bit addressing
-    .ownAddress = I2C2_ADDRESS
+    .ownAddress = I2C2_ADDRESS,
+    .dutyCycle = 0                              // Fast mode Tlow/Thigh = 2
 };
 
-int main(void)
-{
-    SystemInit();                               // Initialize system clock, GPIO, timer
+// I2C2: register map served to remote masters (register 0x00 is a read-only ID)
+#define REG_ID      0x00
+#define REG_MESSAGE 0x01
 
-    I2C_Init(I2C1, &i2c1Config);                // Initialize I2C1 as master
-    I2C_Init(I2C2, &i2c2Config);                // Initialize I2C2 as slave
+uint8_t registers[32] = { [REG_ID] = 0xA5 };
+const uint8_t registersReadOnly[4] = { 1U << REG_ID };
 
-    Log_s("I2C Communication Initialized");     // Log initialization
+// Message transfer: register pointer + message, then a read back, run by the I2C1 interrupts
+const char* message = "Hello from I2C1!";   // Message to transmit
+const uint8_t messageReg = REG_MESSAGE;
+uint8_t messageBuffer[sizeof(registers)];
+uint8_t readBack[sizeof(registers)];
+I2C_Transfer_Typedef messageTransfer;
+I2C_Transfer_Typedef readBackTransfer;
+volatile uint32_t registerWrites;           // Remote writes seen by the slave
 
-    char *message = "Hello from I2C1!";         // Message to transmit
+void onRegistersWritten(uint8_t firstReg, uint16_t length)
+{
+    (void)firstReg;
+    (void)length;
+    registerWrites++;                           // Interrupt context: only count it
+}
 
+I2C_RegisterMap_Typedef regMap = {
+    .registers = registers,
+    .size = sizeof(registers),
+    .readOnly = registersReadOnly,
+    .writeCallback = onRegistersWritten,
+    .writeEvent = Task_Signal                   // Wakes the task awaiting the write
+};
+
+/**
+ * @brief  Message sequence as a stackless task: write the message, wait until the slave has
+ *         stored it, read it back, report, then idle at low power for a second. Each step
+ *         awaits an interrupt driven transfer instead of blocking.
+ */
+static uint8_t messageTask(Task_Typedef* task)
+{
+    static uint32_t writes;                     // Locals do not survive a wait
+
+    TASK_BEGIN(task);
     while (1)
     {
-        I2C_Start(I2C1, I2C2_ADDRESS, 0);       // Master starts transmission to slave (write mode)
+        Clock_SetOperatingPoint(CLOCK_OP_84MHZ);    // Full speed for the burst
+        writes = registerWrites;
+
+        TASK_AWAIT(task, I2C_Transfer_IT(I2C1, &messageTransfer) == I2C_OK);
+        TASK_AWAIT(task, messageTransfer.status != I2C_BUSY);
 
-        for (uint8_t i = 0; message[i] != '\0'; i++)
+        if (messageTransfer.status == I2C_OK)
+        {
+            TASK_AWAIT(task, registerWrites != writes);     // STOP seen by the slave
+
+            TASK_AWAIT(task, I2C_Transfer_IT(I2C1, &readBackTransfer) == I2C_OK);
+            TASK_AWAIT(task, readBackTransfer.status != I2C_BUSY);
+            if (readBackTransfer.status == I2C_OK)
+            {
+                Log_s((char*)readBack);
+            }
+        }
+        else
         {
-            I2C_Write(I2C1, message[i]);        // Send each character
+            Log_s("Message not acknowledged");
+            #if TRACE_ENABLE
+            Trace_Dump(Log_b);                  // Driver events up to the failure, for tools/trace2chrome.py
+            #endif
         }
 
-        I2C_Stop(I2C1);                         // End transmission
+        #if TIME_SLEEP_STATS
+        char sleepReport[24];
+        sprintf(sleepReport, "Asleep: %u%%", Time_sleepPercent());
+        Log_s(sleepReport);                     // Share of the last period spent in WFI
+        #endif
 
-        Delay_ms(1000);                         // Wait before next transmission
+        #if PROFILE_ENABLE
+        Profile_Dump(Log_s);                    // ISR execution time and latency histograms
+        #endif
+
+        #if LOAD_ENABLE
+        Load_Dump(Log_s);                       // CPU load, peak and the share of each account
+        #endif
+
+        Clock_SetOperatingPoint(CLOCK_OP_16MHZ);    // Idle at low power, I2C/Log keep their bit rates
+        TASK_DELAY_US(task, 1000000);
     }
-}
\ No newline at end of file
+    TASK_END(task);
+}
+
+Task_Typedef messageTaskState;
+#if LOAD_ENABLE
+Load_Account_Typedef messageTaskLoad = { .name = "messageTask" };
+#endif
+
+int main(void)
+{
+    SystemInit();                               // Initialize system clock, GPIO, timer
+    Log_init();                                 // Log output on USART1, or ITM/SWO with LOG_ITM
+
+    I2C_Init(I2C1, &i2c1Config);                // Initialize I2C1 as master
+    I2C_Init(I2C2, &i2c2Config);                // Initialize I2C2 as slave
+    I2C_Slave_init(I2C2, &regMap);              // Serve the register map on I2C2
+
+    Log_s("I2C Communication Initialized");     // Log initialization
+
+    messageBuffer[0] = REG_MESSAGE;
+    memcpy(&messageBuffer[1], message, strlen(message) + 1);
+    messageTransfer = (I2C_Transfer_Typedef){
+        .address = I2C2_ADDRESS,
+        .txData = messageBuffer,
+        .txLength = strlen(message) + 2,        // Pointer, text and terminator
+        .event = Task_Signal
+    };
+    readBackTransfer = (I2C_Transfer_Typedef){
+        .address = I2C2_ADDRESS,
+        .txData = &messageReg,                  // Register pointer, then repeated START
+        .txLength = 1,
+        .rxData = readBack,
+        .rxLength = strlen(message) + 1,
+        .event = Task_Signal
+    };
+
+    #if LOAD_ENABLE
+    Load_Register(&messageTaskLoad);
+    messageTaskState.load = &messageTaskLoad;   // Time spent in the task
+    #endif
+    Task_Start(&messageTaskState, messageTask, 0);
+
+    Event_Run();                                // Sleeps until a timer expires or an interrupt posts
+}
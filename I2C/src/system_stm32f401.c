@@ -1,44 +1,12 @@
 #include "main.h"
 
-#define PLLM            (25U)                   // PLLM division factor for PLL input clock
-#define PLLN            (252U << 6)             // PLLN multiplication factor for VCO
-#define PLLP            (1U << 17)              // PLLP division factor for main system clock
-#define PSC_VALUE       41                      // Timer prescaler value for TIM11
-#define ARR_VALUE       0xFFFF                  // Timer auto-reload value for TIM11
+uint32_t SystemCoreClock = CLOCK_HSI;              // Reset clock, updated by SystemCoreClockUpdate
 
-/************************************* System Clock Configuration **************************************
- * Configures the system clock to 42MHz using HSE and PLL.
- */
-static void SysClockConfig_42Mhz()
-{
-    RCC->CR |= RCC_CR_HSEON;                        // Enable High Speed External (HSE) oscillator
-    while (!(RCC->CR & RCC_CR_HSERDY));             // Wait for HSE to be ready
-
-    RCC->PLLCFGR |= RCC_PLLCFGR_PLLSRC_HSE;         // Set HSE as PLL clock source
-
-    RCC->APB1ENR |= RCC_APB1ENR_PWREN;              // Enable Power interface clock
-    PWR->CR |= PWR_CR_VOS_1;                        // Set voltage scaling (Scale 2 mode)
-
-    FLASH->ACR |= FLASH_ACR_LATENCY_2WS             // Set Flash latency to 2 wait states
-                  | FLASH_ACR_DCEN                  // Enable data cache
-                  | FLASH_ACR_PRFTEN                // Enable prefetch
-                  | FLASH_ACR_ICEN;                 // Enable instruction cache
-
-    RCC->PLLCFGR |= PLLM | PLLN | PLLP;             // Set PLLM, PLLN, PLLP for desired frequency
-
-    RCC->CFGR |= RCC_CFGR_HPRE_DIV1                 // Set AHB prescaler to 1
-                 | RCC_CFGR_PPRE1_DIV1              // Set APB1 prescaler to 1
-                 | RCC_CFGR_PPRE2_DIV1;             // Set APB2 prescaler to 1
-
-    RCC->CR |= RCC_CR_PLLON;                        // Enable PLL
-    while (!(RCC->CR & RCC_CR_PLLRDY));             // Wait for PLL to be ready
-
-    RCC->CFGR |= RCC_CFGR_SW_PLL;                   // Select PLL as system clock source
-    while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_1);   // Wait until PLL is used as system clock
-}
+// AHB prescaler (HPRE) code 1xxx to shift: /2, /4, /8, /16, /64, /128, /256, /512
+static const uint8_t ahbShift[8] = {1, 2, 3, 4, 6, 7, 8, 9};
 
 /****************************************** GPIO Configuration *****************************************
- * Configures GPIOB pins for I2C1 (PB6, PB7) and I2C2 (PB8, PB9) alternate function.
+ * Configures GPIOB pins for I2C1 (PB6, PB7) and I2C2 (PB10, PB9) alternate function.
  */
 static void gpioConfig()
 {
@@ -52,46 +20,40 @@ static void gpioConfig()
     GPIOB->PUPDR &= ~((3U << GPIO_PUPDR_PUPD6_Pos) | (3U << GPIO_PUPDR_PUPD7_Pos));         // No pull
     GPIOB->AFR[0] |= (4U << GPIO_AFRL_AFSEL6_Pos) | (4U << GPIO_AFRL_AFSEL7_Pos);           // AF4
 
-    // --- I2C2: PB8 (SCL), PB9 (SDA) ---
-    GPIOB->MODER &= ~((3U << GPIO_MODER_MODER8_Pos) | (3U << GPIO_MODER_MODER9_Pos));       // Clear mode
-    GPIOB->MODER |= (2U << GPIO_MODER_MODER8_Pos) | (2U << GPIO_MODER_MODER9_Pos);          // Set AF mode
-    GPIOB->OTYPER |= GPIO_OTYPER_OT8 | GPIO_OTYPER_OT9;                                     // Open-drain
-    GPIOB->OSPEEDR |= (3U << GPIO_OSPEEDR_OSPEED8_Pos) | (3U << GPIO_OSPEEDR_OSPEED9_Pos);  // High speed
-    GPIOB->PUPDR &= ~((3U << GPIO_PUPDR_PUPD8_Pos) | (3U << GPIO_PUPDR_PUPD9_Pos));         // No pull
-    GPIOB->AFR[1] |= (4U << GPIO_AFRH_AFSEL8_Pos) | (4U << GPIO_AFRH_AFSEL9_Pos);           // AF4
-}
-
-/***************************************** Timer11 Configuration ***************************************
- * Configures TIM11 for delay functions.
- */
-static void timerConfig()
-{
-    RCC->APB2ENR |= RCC_APB2ENR_TIM11EN;            // Enable TIM11 clock
-
-    TIM11->PSC = PSC_VALUE;                         // Set prescaler for desired timer frequency
-    TIM11->ARR = ARR_VALUE;                         // Set auto-reload (max count)
-    TIM11->CR1 |= 0x1;                              // Enable counter
-
-    while (!(TIM11->SR & 1));                       // Wait for update event flag
+    // --- I2C2: PB10 (SCL, AF4), PB9 (SDA, AF9); PB3 (the other SDA choice) stays free for SWO ---
+    GPIOB->MODER &= ~((3U << GPIO_MODER_MODER10_Pos) | (3U << GPIO_MODER_MODER9_Pos));      // Clear mode
+    GPIOB->MODER |= (2U << GPIO_MODER_MODER10_Pos) | (2U << GPIO_MODER_MODER9_Pos);         // Set AF mode
+    GPIOB->OTYPER |= GPIO_OTYPER_OT10 | GPIO_OTYPER_OT9;                                    // Open-drain
+    GPIOB->OSPEEDR |= (3U << GPIO_OSPEEDR_OSPEED10_Pos) | (3U << GPIO_OSPEEDR_OSPEED9_Pos); // High speed
+    GPIOB->PUPDR &= ~((3U << GPIO_PUPDR_PUPD10_Pos) | (3U << GPIO_PUPDR_PUPD9_Pos));        // No pull
+    GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL10 | GPIO_AFRH_AFSEL9);                               // Clear AF
+    GPIOB->AFR[1] |= (4U << GPIO_AFRH_AFSEL10_Pos) | (9U << GPIO_AFRH_AFSEL9_Pos);          // AF4 SCL, AF9 SDA
 }
 
 /***************************************** Microsecond Delay *******************************************
- * Generates a delay in microseconds using TIM11.
+ * Waits for a deadline on the free running TIM5 time base (see Time.c). Nothing is reset, so
+ * delays can nest or run from interrupts, and the I2C timeouts keep timing meanwhile.
  */
-void Delay_us(uint16_t us)
+void Delay_us(uint32_t us)
 {
-    TIM11->CNT = 0;                                 // Reset counter
-    while (TIM11->CNT < us);
+    uint32_t deadline = Time_deadline_us(us);
+    while (!Time_expired(deadline));
 }
 
 /***************************************** Millisecond Delay *******************************************
- * Generates a delay in milliseconds using TIM11.
+ * Sleeps (WFI) until the deadline; interrupts keep being served while waiting. Called from an
+ * interrupt it spins instead (see Time_sleepUntil).
  */
-void Delay_ms(uint16_t ms)
+void Delay_ms(uint32_t ms)
 {
-    for (uint16_t i=0; i<ms; i++)
+    uint32_t deadline = Time_now_us();
+
+    while (ms)
     {
-        Delay_us(1000);                             // 1ms = 1000us
+        uint32_t chunk = (ms > 1000000) ? 1000000 : ms;     // Deadlines stay within the 32-bit range
+        deadline += chunk * 1000;                           // 1ms = 1000us
+        Time_sleepUntil(deadline);
+        ms -= chunk;
     }
 }
 
@@ -100,12 +62,44 @@ void Delay_ms(uint16_t ms)
  */
 void SystemInit(void)
 {
-    SysClockConfig_42Mhz();                         // Configure system clock to 42MHz
+    Clock_init(CLOCK_SYSCLK);                       // Configure system clock to 84MHz (Clock.h)
     gpioConfig();                                   // Configure GPIOB for I2C
-    timerConfig();                                  // Configure TIM11 for delays
+    Time_init();                                    // Start the TIM5 microsecond time base
+    #if PROFILE_ENABLE
+    Profile_init();                                 // DWT cycle counter and latency probe
+    #endif
+    #if LOAD_ENABLE
+    Load_init();                                    // CPU load sampled from the idle time
+    #endif
+    #if TRACE_ENABLE
+    Trace_init();                                   // Driver event trace in RAM
+    #endif
 }
 
+/************************************ SystemCoreClockUpdate ********************************************
+ * Updates SystemCoreClock from the running clock tree (SYSCLK source, PLL factors and AHB
+ * prescaler). Clock_init calls it after every change.
+ */
 void SystemCoreClockUpdate(void)
 {
-    // Typically updates SystemCoreClock variable, if used
-}
\ No newline at end of file
+    uint32_t source = RCC->CFGR & RCC_CFGR_SWS;
+    uint32_t sysclk = CLOCK_HSI;
+
+    if (source == RCC_CFGR_SWS_HSE)
+    {
+        sysclk = CLOCK_HSE;
+    }
+    else if (source == RCC_CFGR_SWS_PLL)
+    {
+        uint32_t pllcfgr = RCC->PLLCFGR;
+        uint32_t input = (pllcfgr & RCC_PLLCFGR_PLLSRC) ? CLOCK_HSE : CLOCK_HSI;
+        uint32_t m = (pllcfgr & RCC_PLLCFGR_PLLM) >> RCC_PLLCFGR_PLLM_Pos;
+        uint32_t n = (pllcfgr & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+        uint32_t p = (((pllcfgr & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1) * 2;
+
+        sysclk = (input / m) * n / p;
+    }
+
+    uint32_t hpre = (RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos;     // 0xxx: /1, 1000-1111: /2../512
+    SystemCoreClock = (hpre & 0x8) ? sysclk >> ahbShift[hpre & 0x7] : sysclk;
+}
@@ -0,0 +1,148 @@
+#include <string.h>
+#include "EEPROMModel.h"
+
+EEPROM_Model_Typedef eepromModel;
+
+/**
+ * @brief  Block bits: device address bits used as memory address bits above the word address.
+ */
+static uint8_t EEPROMModel_BlockMask(void)
+{
+    uint32_t blocks = eepromModel.capacity >> (8 * eepromModel.addressBytes);
+
+    return blocks ? (uint8_t)(blocks - 1) : 0;
+}
+
+static uint8_t EEPROMModel_Writing(void)
+{
+    return eepromModel.stuck || hostTimeUs < eepromModel.writeEnd;
+}
+
+/**
+ * @brief  Erased (0xFF) chip with the given geometry, idle, counters cleared.
+ */
+void EEPROMModel_Reset(uint8_t addressBytes, uint16_t pageSize, uint32_t capacity)
+{
+    memset(&eepromModel, 0, sizeof(eepromModel));
+    memset(eepromModel.memory, 0xFF, sizeof(eepromModel.memory));
+    eepromModel.address = 0x50;
+    eepromModel.addressBytes = addressBytes;
+    eepromModel.pageSize = pageSize;
+    eepromModel.capacity = capacity;
+    hostTimeUs = 0;
+}
+
+/*********************************** I2C.c replacements ***************************************
+ * @brief  Blocking master calls as seen by the chip. While a write cycle runs the chip does not
+ *         acknowledge its address; a STOP after data bytes starts the write cycle of the page.
+ */
+uint8_t I2C_Start(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t isRead)
+{
+    uint8_t block = slaveAddr & EEPROMModel_BlockMask();
+
+    (void)I2Cx;
+    (void)isRead;
+    HostTime_Advance(EEPROM_MODEL_START_US);
+    eepromModel.active = 0;                     // Repeated START drops an unfinished page write
+    eepromModel.latchBytes = 0;
+
+    if ((slaveAddr & ~EEPROMModel_BlockMask()) != eepromModel.address)
+    {
+        HostTime_Advance(EEPROM_MODEL_STOP_US);
+        return I2C_ERROR_AF;                    // Not our address, driver sent STOP
+    }
+    if (EEPROMModel_Writing())
+    {
+        eepromModel.nacks++;
+        HostTime_Advance(EEPROM_MODEL_STOP_US);
+        return I2C_ERROR_AF;
+    }
+
+    eepromModel.active = 1;
+    eepromModel.device = slaveAddr;
+    eepromModel.index = 0;
+    eepromModel.blocks[block]++;
+    memset(eepromModel.latched, 0, sizeof(eepromModel.latched));
+    return I2C_OK;
+}
+
+uint8_t I2C_Write(I2C_TypeDef* I2Cx, uint8_t data)
+{
+    (void)I2Cx;
+    HostTime_Advance(EEPROM_MODEL_BYTE_US);
+    if (!eepromModel.active)
+    {
+        return I2C_ERROR_AF;
+    }
+
+    uint32_t index = eepromModel.index++;
+    if (index < eepromModel.addressBytes)
+    {
+        eepromModel.pointer = (index == 0) ? data : (eepromModel.pointer << 8) | data;
+        if (index + 1 == eepromModel.addressBytes)
+        {
+            uint32_t block = eepromModel.device & EEPROMModel_BlockMask();
+            eepromModel.pointer = ((block << (8 * eepromModel.addressBytes)) | eepromModel.pointer)
+                                  % eepromModel.capacity;
+        }
+        return I2C_OK;
+    }
+
+    uint32_t column = (eepromModel.pointer + eepromModel.latchBytes++) % eepromModel.pageSize;
+    eepromModel.latch[column] = data;
+    eepromModel.latched[column] = 1;
+    return I2C_OK;
+}
+
+uint8_t I2C_Stop(I2C_TypeDef* I2Cx)
+{
+    (void)I2Cx;
+    HostTime_Advance(EEPROM_MODEL_STOP_US);
+    if (eepromModel.active && eepromModel.latchBytes)
+    {
+        uint32_t page = eepromModel.pointer - (eepromModel.pointer % eepromModel.pageSize);
+
+        if (eepromModel.pointer % eepromModel.pageSize + eepromModel.latchBytes > eepromModel.pageSize)
+        {
+            eepromModel.pageWraps++;
+        }
+        for (uint32_t column = 0; column < eepromModel.pageSize; column++)
+        {
+            if (eepromModel.latched[column])
+            {
+                eepromModel.memory[page + column] = eepromModel.latch[column];
+            }
+        }
+        eepromModel.pageWrites++;
+        eepromModel.writeEnd = hostTimeUs + EEPROM_MODEL_TWR_US;
+    }
+    eepromModel.active = 0;
+    eepromModel.latchBytes = 0;
+    return I2C_OK;
+}
+
+/**
+ * @brief  Repeated START in read direction, sequential read from the address counter (rolls
+ *         over at the end of the memory), NACK on the last byte and STOP.
+ */
+uint8_t I2C_ReadBurst(I2C_TypeDef* I2Cx, uint16_t slaveAddr, uint8_t* data, uint16_t length)
+{
+    uint32_t pointer = eepromModel.pointer;
+
+    (void)I2Cx;
+    if (eepromModel.active && (slaveAddr & EEPROMModel_BlockMask()) != (eepromModel.device & EEPROMModel_BlockMask()))
+    {
+        eepromModel.blockMismatches++;
+    }
+    if (I2C_Start(I2Cx, slaveAddr, 1) != I2C_OK)
+    {
+        return I2C_ERROR_AF;
+    }
+    for (uint16_t i = 0; i < length; i++)
+    {
+        data[i] = eepromModel.memory[(pointer + i) % eepromModel.capacity];
+        HostTime_Advance(EEPROM_MODEL_BYTE_US);
+    }
+    eepromModel.pointer = (pointer + length) % eepromModel.capacity;
+    return I2C_Stop(I2Cx);
+}
@@ -0,0 +1,50 @@
+#ifndef EEPROM_MODEL_H_
+#define EEPROM_MODEL_H_
+
+#include <stdint.h>
+#include "I2C.h"
+#include "HostTime.h"
+
+#define EEPROM_MODEL_MAX    0x8000          // Largest chip emulated (24C256)
+#define EEPROM_MODEL_TWR_US 3000            // Typical write cycle (data sheets give 5 ms max)
+
+// bus time at 100 kHz, charged to the host time base
+#define EEPROM_MODEL_START_US   100         // START and address byte
+#define EEPROM_MODEL_BYTE_US    90          // Data byte and acknowledge
+#define EEPROM_MODEL_STOP_US    10
+
+// use declared struct to describe and inspect the emulated 24Cxx chip
+// ex: 24C16: { .address = 0x50, .addressBytes = 1, .pageSize = 16, .capacity = 2048 }
+typedef struct
+{
+    uint8_t address;                        // Device address with the block bits low
+    uint8_t addressBytes;
+    uint16_t pageSize;
+    uint32_t capacity;
+    uint8_t stuck;                          // 1: the write cycle never ends
+    uint8_t memory[EEPROM_MODEL_MAX];
+
+    // transaction state
+    uint8_t active;                         // Addressed, STOP not seen yet
+    uint8_t device;                         // Device address of the transaction
+    uint32_t index;                         // Bytes received in the write transaction
+    uint32_t pointer;                       // Internal address counter
+    uint8_t latch[256];                     // Page buffer, wraps inside the page
+    uint8_t latched[256];
+    uint32_t latchBytes;
+    uint64_t writeEnd;                      // Host time the write cycle ends
+
+    // counters
+    uint32_t pageWrites;
+    uint32_t pageWraps;                     // Page writes that wrapped inside their page
+    uint32_t nacks;                         // Address NACKed during a write cycle
+    uint32_t blocks[8];                     // Transactions by device address block bits
+    uint32_t blockMismatches;               // Read addressed to another block than its word address
+}EEPROM_Model_Typedef;
+
+extern EEPROM_Model_Typedef eepromModel;
+
+// function declaration
+void EEPROMModel_Reset(uint8_t addressBytes, uint16_t pageSize, uint32_t capacity);
+
+#endif
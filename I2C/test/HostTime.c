@@ -0,0 +1,35 @@
+#include "HostTime.h"
+
+uint64_t hostTimeUs;
+uint32_t hostFailures;
+
+void HostTime_Advance(uint32_t us)
+{
+    hostTimeUs += us;
+}
+
+/*********************************** Time.c replacements **************************************/
+uint32_t Time_now_us(void)
+{
+    return (uint32_t)hostTimeUs;
+}
+
+uint64_t Time_now_us64(void)
+{
+    return hostTimeUs;
+}
+
+uint32_t Time_elapsed_us(uint32_t since)
+{
+    return (uint32_t)hostTimeUs - since;
+}
+
+uint32_t Time_deadline_us(uint32_t us)
+{
+    return (uint32_t)hostTimeUs + us;
+}
+
+uint8_t Time_expired(uint32_t deadline)
+{
+    return (int32_t)((uint32_t)hostTimeUs - deadline) >= 0;
+}
@@ -0,0 +1,14 @@
+#ifndef HOST_TIME_H_
+#define HOST_TIME_H_
+
+#include <stdint.h>
+#include "Time.h"
+
+// host replacement of Time.c: the microsecond time base only moves when a model charges the
+// bus time of what the driver did, so waits and timeouts run the same on every machine
+extern uint64_t hostTimeUs;
+
+// function declaration
+void HostTime_Advance(uint32_t us);
+
+#endif
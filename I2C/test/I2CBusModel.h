@@ -0,0 +1,34 @@
+#ifndef I2C_BUS_MODEL_H_
+#define I2C_BUS_MODEL_H_
+
+#include <stdint.h>
+#include "I2C.h"
+#include "HostTime.h"
+
+#define I2C_BUS_MODEL_LOG   64              // Transfers remembered, in start order
+
+// use declared struct to drive and inspect the emulated interrupt driven bus
+typedef struct
+{
+    uint8_t registers[128][256];            // Register file of every 7-bit slave
+    I2C_Transfer_Typedef* running;          // Started, completion not delivered yet
+    uint8_t busyStarts;                     // Next starts refused with I2C_BUSY (bus taken)
+
+    // counters
+    uint32_t starts;                        // Transfers accepted
+    uint32_t refused;                       // Starts answered I2C_BUSY
+    uint32_t overlaps;                      // Starts while a transfer was running
+    uint32_t completionStarts;              // Starts made from inside a completion callback
+    uint8_t inCallback;
+    uint16_t address[I2C_BUS_MODEL_LOG];    // Slave of every accepted start
+    uint8_t reg[I2C_BUS_MODEL_LOG];         // Register pointer of every accepted start
+}I2CBusModel_Typedef;
+
+extern I2CBusModel_Typedef i2cBus;
+
+// function declaration
+void I2CBusModel_Reset(void);
+uint8_t I2CBusModel_Complete(uint8_t status);
+uint32_t I2CBusModel_RunAll(void);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef HOST_H_
+#define HOST_H_
+
+// Forced into every host test build (gcc -include): test bookkeeping shared by the models.
+// The drivers under test only reach the hardware through I2C.c and Time.c, which the
+// models replace.
+
+#include <stdint.h>
+#include <stdio.h>
+#include "stm32f401xc.h"
+
+// CHECK records a failure and carries on, the main returns the count
+extern uint32_t hostFailures;
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            hostFailures++;                                                     \
+        }                                                                       \
+    } while (0)
+
+#endif
@@ -0,0 +1,138 @@
+#include <string.h>
+#include "EEPROM.h"
+#include "EEPROMModel.h"
+
+static EEPROM_Typedef eeprom;
+static uint8_t pattern[256];
+static uint8_t readBack[256];
+
+/**
+ * @brief  Erased chip and a driver descriptor with the same geometry.
+ */
+static void Setup(uint8_t addressBytes, uint16_t pageSize, uint32_t capacity)
+{
+    EEPROMModel_Reset(addressBytes, pageSize, capacity);
+    eeprom = (EEPROM_Typedef){ .I2Cx = I2C1, .address = 0x50, .addressBytes = addressBytes,
+                               .pageSize = pageSize, .capacity = capacity };
+
+    for (uint32_t i = 0; i < sizeof(pattern); i++)
+    {
+        pattern[i] = (uint8_t)(i * 11 + 5);
+    }
+}
+
+/**
+ * @brief  24C32: an unaligned write is split into page writes that never wrap inside a page,
+ *         and the pages follow each other as soon as ACK polling sees the write cycle end.
+ */
+static void Test_PageSplit(void)
+{
+    Setup(2, 32, 4096);
+
+    CHECK(EEPROM_Write(&eeprom, 0x1E, pattern, 100) == EEPROM_OK);    // 2 + 32 + 32 + 32 + 2
+    CHECK(eeprom.busy == 1);                    // Returns during the last write cycle
+    CHECK(eeprom.stats.pageWrites == 5);
+    CHECK(eepromModel.pageWrites == 5);
+    CHECK(eepromModel.pageWraps == 0);
+    CHECK(hostTimeUs < 4 * 5000 + 5 * (EEPROM_MODEL_START_US + 2 * EEPROM_MODEL_BYTE_US
+                      + EEPROM_MODEL_STOP_US) + 100 * EEPROM_MODEL_BYTE_US);   // Beats fixed 5 ms waits
+
+    CHECK(EEPROM_Read(&eeprom, 0x1E, readBack, 100) == EEPROM_OK);
+    CHECK(memcmp(readBack, pattern, 100) == 0);
+    CHECK(eepromModel.memory[0x1D] == 0xFF);
+    CHECK(eepromModel.memory[0x1E + 100] == 0xFF);
+}
+
+/**
+ * @brief  24C16: address bits 8..10 travel in the device address, so a write and a read that
+ *         cross 0x400 address blocks 3 and 4 separately.
+ */
+static void Test_BlockBits(void)
+{
+    Setup(1, 16, 2048);
+
+    CHECK(EEPROM_Write(&eeprom, 0x3F8, pattern, 16) == EEPROM_OK);
+    CHECK(EEPROM_WaitReady(&eeprom) == EEPROM_OK);
+    CHECK(eepromModel.blocks[3] >= 1);
+    CHECK(eepromModel.blocks[4] >= 1);
+    CHECK(memcmp(&eepromModel.memory[0x3F8], pattern, 16) == 0);
+    CHECK(eepromModel.memory[0x0F8] == 0xFF);   // Not folded into block 0
+
+    memset(eepromModel.blocks, 0, sizeof(eepromModel.blocks));
+    CHECK(EEPROM_Read(&eeprom, 0x3F0, readBack, 0x20) == EEPROM_OK);
+    CHECK(memcmp(&readBack[8], pattern, 16) == 0);
+    CHECK(eepromModel.blocks[3] == 2);          // Word address write, then read
+    CHECK(eepromModel.blocks[4] == 2);
+    CHECK(eepromModel.blockMismatches == 0);
+
+    CHECK(EEPROM_Write(&eeprom, 0x7FF, pattern, 1) == EEPROM_OK);
+    CHECK(eepromModel.memory[0x7FF] == pattern[0]);
+}
+
+/**
+ * @brief  ACK polling: the chip NACKs its address during the write cycle; every NACK is one
+ *         poll, and the first ACK ends the busy state.
+ */
+static void Test_AckPolling(void)
+{
+    Setup(2, 32, 4096);
+
+    CHECK(EEPROM_Write(&eeprom, 0, pattern, 8) == EEPROM_OK);
+    uint64_t start = hostTimeUs;                // STOP sent: write cycle running
+
+    CHECK(EEPROM_IsBusy(&eeprom) == 1);
+    CHECK(EEPROM_WaitReady(&eeprom) == EEPROM_OK);
+    CHECK(EEPROM_IsBusy(&eeprom) == 0);
+    CHECK(eeprom.stats.ackPolls == eepromModel.nacks);
+    CHECK(eeprom.stats.ackPolls > 1);
+    CHECK(hostTimeUs - start >= EEPROM_MODEL_TWR_US);
+    CHECK(hostTimeUs - start <= EEPROM_MODEL_TWR_US
+                                + 2 * (EEPROM_MODEL_START_US + EEPROM_MODEL_STOP_US));  // One poll late at most
+}
+
+/**
+ * @brief  A write cycle that never ends: the next access gives up after EEPROM_WRITE_TIMEOUT_US.
+ */
+static void Test_WriteTimeout(void)
+{
+    Setup(2, 32, 4096);
+
+    CHECK(EEPROM_Write(&eeprom, 0, pattern, 8) == EEPROM_OK);
+    eepromModel.stuck = 1;
+    uint64_t start = hostTimeUs;
+
+    CHECK(EEPROM_Write(&eeprom, 8, pattern, 8) == EEPROM_TIMEOUT);
+    CHECK(hostTimeUs - start >= EEPROM_WRITE_TIMEOUT_US);
+    CHECK(hostTimeUs - start < EEPROM_WRITE_TIMEOUT_US + 1000);
+    CHECK(EEPROM_Read(&eeprom, 0, readBack, 8) == EEPROM_TIMEOUT);
+    CHECK(eepromModel.pageWrites == 1);
+
+    eepromModel.stuck = 0;
+    CHECK(EEPROM_Read(&eeprom, 0, readBack, 8) == EEPROM_OK);
+    CHECK(memcmp(readBack, pattern, 8) == 0);
+}
+
+/**
+ * @brief  Ranges ending past the chip are refused, including those whose end wraps 32 bits.
+ */
+static void Test_Bounds(void)
+{
+    Setup(2, 32, 4096);
+
+    CHECK(EEPROM_Write(&eeprom, 4096 - 8, pattern, 8) == EEPROM_OK);
+    CHECK(EEPROM_Write(&eeprom, 4096 - 8, pattern, 9) == EEPROM_OUT_OF_RANGE);
+    CHECK(EEPROM_Write(&eeprom, 0xFFFFFFF0, pattern, 0x20) == EEPROM_OUT_OF_RANGE);
+    CHECK(EEPROM_Read(&eeprom, 0xFFFFFFF0, readBack, 0x20) == EEPROM_OUT_OF_RANGE);
+}
+
+int main(void)
+{
+    Test_PageSplit();
+    Test_BlockBits();
+    Test_AckPolling();
+    Test_WriteTimeout();
+    Test_Bounds();
+
+    printf("EEPROM: %s (%u failures)\n", hostFailures ? "FAIL" : "ok", (unsigned)hostFailures);
+    return hostFailures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+#include "I2CSched.h"
+#include "I2CBusModel.h"
+
+enum { JOB_ACCEL, JOB_MAG, JOB_BARO, JOB_COUNT };
+
+static I2CSched_Job_Typedef jobs[JOB_COUNT];
+static I2CSched_Typedef sched;
+static uint8_t snapshot[I2CSCHED_MAX_LENGTH];
+
+/**
+ * @brief  Idle bus at time 0 and three sensors with different periods, all due now.
+ */
+static void Setup(void)
+{
+    hostTimeUs = 0;
+    I2CBusModel_Reset();
+
+    jobs[JOB_ACCEL] = (I2CSched_Job_Typedef){ .address = 0x68, .reg = 0x3B, .length = 6, .periodMs = 10 };
+    jobs[JOB_MAG] = (I2CSched_Job_Typedef){ .address = 0x1E, .reg = 0x03, .length = 6, .periodMs = 5 };
+    jobs[JOB_BARO] = (I2CSched_Job_Typedef){ .address = 0x77, .reg = 0xF7, .length = 3, .periodMs = 20 };
+    sched = (I2CSched_Typedef){ .I2Cx = I2C1, .jobs = jobs, .jobCount = JOB_COUNT };
+    I2CSched_init(&sched);
+}
+
+/**
+ * @brief  A batch runs in the order of the due times it was gathered with, and each due time
+ *         only moves on once its read has started.
+ */
+static void Test_EarliestDeadline(void)
+{
+    Setup();
+    jobs[JOB_ACCEL].due = 2;
+    jobs[JOB_MAG].due = 0;
+    jobs[JOB_BARO].due = 1;
+
+    I2CSched_Poll(&sched);
+    CHECK(sched.batchCount == 1);
+    CHECK(i2cBus.starts == 1);                  // Only the first read starts from the main loop
+    CHECK(jobs[JOB_MAG].due == 5);
+    CHECK(jobs[JOB_BARO].due == 1);             // Not started yet: still ordered by this period
+    CHECK(jobs[JOB_ACCEL].due == 2);
+
+    CHECK(I2CBusModel_RunAll() == 3);
+    CHECK(i2cBus.address[0] == 0x1E);
+    CHECK(i2cBus.address[1] == 0x77);
+    CHECK(i2cBus.address[2] == 0x68);
+    CHECK(jobs[JOB_BARO].due == 21);
+    CHECK(jobs[JOB_ACCEL].due == 12);
+    CHECK(sched.batch == 0);
+}
+
+/**
+ * @brief  The reads of a batch are chained from the completion callbacks, never overlap, and
+ *         publish snapshots; a failed read keeps the previous snapshot.
+ */
+static void Test_Chaining(void)
+{
+    Setup();
+    I2CSched_Poll(&sched);
+    CHECK(I2CBusModel_RunAll() == 3);
+    CHECK(i2cBus.completionStarts == 2);
+    CHECK(i2cBus.overlaps == 0);
+    CHECK(sched.readCount == 3);
+
+    CHECK(I2CSched_Read(&jobs[JOB_ACCEL], snapshot) == 1);
+    CHECK(memcmp(snapshot, &i2cBus.registers[0x68][0x3B], 6) == 0);
+    CHECK(I2CSched_Read(&jobs[JOB_BARO], snapshot) == 1);
+    CHECK(memcmp(snapshot, &i2cBus.registers[0x77][0xF7], 3) == 0);
+
+    hostTimeUs = 5000;                          // Only the 5 ms job is due again
+    i2cBus.registers[0x1E][0x03] ^= 0xFF;
+    I2CSched_Poll(&sched);
+    CHECK(sched.batchCount == 2);
+    CHECK(I2CBusModel_Complete(I2C_ERROR_AF) == 1);
+    CHECK(I2CBusModel_RunAll() == 0);
+    CHECK(jobs[JOB_MAG].errorCount == 1);
+    CHECK(I2CSched_Read(&jobs[JOB_MAG], snapshot) == 1);
+    CHECK(snapshot[0] == (uint8_t)(i2cBus.registers[0x1E][0x03] ^ 0xFF));
+}
+
+/**
+ * @brief  A start refused because the bus is taken leaves the job in the batch with its due
+ *         time unchanged, and the next poll resumes the batch.
+ */
+static void Test_BusTaken(void)
+{
+    Setup();
+    i2cBus.busyStarts = 1;
+    I2CSched_Poll(&sched);
+    CHECK(i2cBus.starts == 0);
+    CHECK(sched.batch == (1U << JOB_COUNT) - 1);
+    CHECK(jobs[JOB_MAG].due == 0);
+
+    I2CSched_Poll(&sched);                      // Resumes
+    CHECK(i2cBus.starts == 1);
+    i2cBus.busyStarts = 1;                      // Chained start refused too
+    CHECK(I2CBusModel_Complete(I2C_OK) == 1);
+    CHECK(i2cBus.running == 0);
+    CHECK(sched.batchCount == 1);
+
+    I2CSched_Poll(&sched);
+    CHECK(I2CBusModel_RunAll() == 2);
+    CHECK(sched.batchCount == 1);               // Same batch, not a new one
+    CHECK(sched.readCount == 3);
+    CHECK(sched.batch == 0);
+}
+
+/**
+ * @brief  Jobs due within I2CSCHED_LOOKAHEAD_MS join the batch, later ones wait; a scheduler
+ *         that fell behind skips the missed periods instead of reading back-to-back.
+ */
+static void Test_LookaheadAndCatchUp(void)
+{
+    Setup();
+    jobs[JOB_ACCEL].due = I2CSCHED_LOOKAHEAD_MS;
+    jobs[JOB_BARO].due = I2CSCHED_LOOKAHEAD_MS + 1;
+    I2CSched_Poll(&sched);
+    CHECK(I2CBusModel_RunAll() == 2);
+    CHECK(jobs[JOB_BARO].due == I2CSCHED_LOOKAHEAD_MS + 1);
+
+    hostTimeUs = 100000;                        // 100 ms without a poll
+    I2CSched_Poll(&sched);
+    CHECK(I2CBusModel_RunAll() == 3);
+    CHECK(jobs[JOB_MAG].due == 100 + 5);
+    CHECK(jobs[JOB_ACCEL].due == 100 + 10);
+    CHECK(jobs[JOB_BARO].due == 100 + 20);
+
+    I2CSched_Poll(&sched);
+    CHECK(i2cBus.running == 0);                 // Nothing due right after catching up
+}
+
+int main(void)
+{
+    Test_EarliestDeadline();
+    Test_Chaining();
+    Test_BusTaken();
+    Test_LookaheadAndCatchUp();
+
+    printf("I2CSched: %s (%u failures)\n", hostFailures ? "FAIL" : "ok", (unsigned)hostFailures);
+    return hostFailures ? 1 : 0;
+}
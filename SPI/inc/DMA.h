@@ -0,0 +1,53 @@
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+
+// use declared enum to select DMA transfer direction
+enum DMA_direction
+{
+    DMA_PERIPH_TO_MEM,
+    DMA_MEM_TO_PERIPH
+};
+
+// use declared enum to select DMA data size (peripheral and memory side)
+enum DMA_dataSize
+{
+    DMA_SIZE_8,
+    DMA_SIZE_16,
+    DMA_SIZE_32
+};
+
+// stream status flags (normalised, same layout for every stream)
+#define DMA_FLAG_FE     (1U << 0)       // FIFO error
+#define DMA_FLAG_DME    (1U << 2)       // Direct mode error
+#define DMA_FLAG_TE     (1U << 3)       // Transfer error
+#define DMA_FLAG_HT     (1U << 4)       // Half transfer
+#define DMA_FLAG_TC     (1U << 5)       // Transfer complete
+#define DMA_FLAG_ALL    (DMA_FLAG_FE | DMA_FLAG_DME | DMA_FLAG_TE | DMA_FLAG_HT | DMA_FLAG_TC)
+
+// use declared struct to configure a DMA stream
+typedef struct
+{
+    uint8_t channel;            // Request channel (0-7), see RM0368 DMA request mapping
+    uint8_t direction;          // DMA_PERIPH_TO_MEM or DMA_MEM_TO_PERIPH
+    uint8_t dataSize;           // DMA_SIZE_8, DMA_SIZE_16 or DMA_SIZE_32
+    uint8_t memIncrement;       // 1: increment memory address after each item
+    uint8_t circular;           // 1: circular mode (NDTR reloads automatically)
+    uint8_t priority;           // 0 (low) to 3 (very high)
+    uint8_t interruptTC;        // 1: enable transfer complete interrupt
+    uint8_t interruptHT;        // 1: enable half transfer interrupt
+}DMA_Config_Typedef;
+
+// function declaration
+void DMA_init(DMA_Stream_TypeDef* stream, DMA_Config_Typedef* dmaConfig);
+void DMA_Start(DMA_Stream_TypeDef* stream, volatile void* periphAddr, const void* memAddr, uint16_t count);
+void DMA_Stop(DMA_Stream_TypeDef* stream);
+void DMA_SetMemIncrement(DMA_Stream_TypeDef* stream, uint8_t enable);
+void DMA_ClearFlags(DMA_Stream_TypeDef* stream, uint8_t flags);
+
+uint8_t DMA_GetFlags(DMA_Stream_TypeDef* stream);
+uint16_t DMA_Remaining(DMA_Stream_TypeDef* stream);
+
+#endif
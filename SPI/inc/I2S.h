@@ -0,0 +1,88 @@
+#ifndef I2S_H_
+#define I2S_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "DMA.h"
+#include "Clock.h"
+#include "Profile.h"
+
+// macros contains I2S address (SPI2 and SPI3 double as I2S)
+#define I2S_2 (void*)(SPI2_BASE)
+#define I2S_3 (void*)(SPI3_BASE)
+
+// set value as 1 to enable the streaming DMA interrupts of the instance
+// (I2S2: DMA1 Stream4 TX / Stream3 RX, I2S3: DMA1 Stream5 TX / Stream0 RX)
+// I2S2 takes DMA1 Stream3/4 from the SPI2 slave frame engine: SPI2_SLAVE_FRAME_ENABLE must be 0
+#define I2S2_STREAM_ENABLE 0
+#define I2S3_STREAM_ENABLE 0
+
+// PLLI2S input clock: HSE / PLLM shared with the main PLL, see SysClockConfig_PLLI2S
+#define I2S_PLL_INPUT_CLK (CLOCK_HSE / CLOCK_PLLM)
+
+// use declared enum to read I2S_StartStream result
+enum I2S_status
+{
+    I2S_OK,
+    I2S_ERROR                   // Not I2S2/I2S3, or its I2Sx_STREAM_ENABLE is 0
+};
+
+// use declared enum to select I2S operation mode
+enum I2S_mode
+{
+    I2S_SLAVE_TX,
+    I2S_SLAVE_RX,
+    I2S_MASTER_TX,
+    I2S_MASTER_RX
+};
+
+// use declared enum to select I2S standard
+enum I2S_standard
+{
+    I2S_PHILIPS,
+    I2S_MSB_JUSTIFIED,
+    I2S_LSB_JUSTIFIED,
+    I2S_PCM
+};
+
+// use declared enum to select sample format
+enum I2S_dataFormat
+{
+    I2S_16BIT,              // 16-bit data, 16-bit channel
+    I2S_16BIT_EXTENDED,     // 16-bit data, 32-bit channel
+    I2S_24BIT,              // 24-bit data, 32-bit channel (two halfwords per sample)
+    I2S_32BIT               // 32-bit data, 32-bit channel (two halfwords per sample)
+};
+
+// called from the DMA interrupt with the half of the buffer the application owns now
+typedef void (*I2S_Callback_Typedef)(uint16_t* half, uint16_t halfLength);
+
+// use declared struct to configure I2S function
+typedef struct
+{
+    uint8_t mode;
+    uint8_t standard;
+    uint8_t dataFormat;
+    uint8_t CPOL;                       // 1: clock idle high
+    uint8_t MCLKoutput;                 // 1: master clock output (256 x Fs)
+    uint32_t sampleRate;                // Audio sample rate in Hz (master modes)
+}I2Sconfig_Typedef;
+
+// use declared struct to describe a circular stream
+// ex: (in main code)
+// I2S_Stream_Typedef audio = { .buffer = samples, .length = 2 * 256, .halfCallback = fill, .fullCallback = fill };
+typedef struct
+{
+    uint16_t* buffer;                   // Circular sample buffer (halfwords, MSB halfword first for 24/32-bit)
+    uint16_t length;                    // Buffer length in halfwords (even)
+    I2S_Callback_Typedef halfCallback;  // First half free (TX) or filled (RX)
+    I2S_Callback_Typedef fullCallback;  // Second half free (TX) or filled (RX)
+    volatile uint32_t errorCount;       // DMA transfer errors
+}I2S_Stream_Typedef;
+
+// function declaration
+uint32_t I2S_init(SPI_TypeDef* I2S, I2Sconfig_Typedef* I2Sconfig);
+uint8_t I2S_StartStream(SPI_TypeDef* I2S, I2S_Stream_Typedef* stream);
+void I2S_StopStream(SPI_TypeDef* I2S);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SD_CARD_H_
+#define SD_CARD_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "SPI.h"
+
+#define SDCARD_SECTOR_SIZE      512
+
+// identification runs below 400 kHz, data transfer at the fastest rate the card allows
+// (prescalers computed from the running APB clock, see SPI_GetPrescaler)
+#define SDCARD_INIT_FREQ        400000      // 328 kHz with 42 MHz APB1
+#define SDCARD_FAST_FREQ        25000000    // 21 MHz with 42 MHz APB1 (card limit)
+
+// use declared enum to read SD card operation status
+enum SDCard_status
+{
+    SD_OK,
+    SD_NO_CARD,
+    SD_UNSUPPORTED,
+    SD_TIMEOUT,
+    SD_READ_ERROR,
+    SD_WRITE_ERROR,
+    SD_BAD_ARGUMENT
+};
+
+// use declared enum to read detected card type
+enum SDCard_type
+{
+    SD_TYPE_NONE,
+    SD_TYPE_SDSC_V1,
+    SD_TYPE_SDSC_V2,
+    SD_TYPE_SDHC                            // SDHC/SDXC, block addressed
+};
+
+// use declared struct to describe a card slot
+// ex: (in main code)
+// SDCard_Typedef card = { .SPI = SPI3, .csPort = GPIOA, .csPin = 15 };
+typedef struct
+{
+    SPI_TypeDef* SPI;                       // SPI master, software NSS, 8-bit, mode 0
+    GPIO_TypeDef* csPort;                   // Chip select port
+    uint8_t csPin;                          // Chip select pin number
+    uint8_t type;                           // Filled in by SDCard_init
+    uint32_t sectorCount;                   // Filled in by SDCard_init (from CSD)
+}SDCard_Typedef;
+
+// sequential throughput measured by SDCard_Benchmark
+typedef struct
+{
+    uint32_t writeBytesPerSec;
+    uint32_t readBytesPerSec;
+    uint8_t status;
+}SDCard_Bench_Typedef;
+
+// function declaration
+uint8_t SDCard_init(SDCard_Typedef* card);
+uint8_t SDCard_ReadSectors(SDCard_Typedef* card, uint32_t sector, uint8_t* data, uint32_t count);
+uint8_t SDCard_WriteSectors(SDCard_Typedef* card, uint32_t sector, const uint8_t* data, uint32_t count);
+void SDCard_Benchmark(SDCard_Typedef* card, uint32_t sector, uint8_t* buffer, uint32_t bufferSectors,
+                      uint32_t totalSectors, SDCard_Bench_Typedef* result);
+
+#endif
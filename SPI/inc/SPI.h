@@ -3,6 +3,11 @@
 
 #include <stdint.h>
 #include "stm32f401xc.h"
+#include "Clock.h"
+#include "DMA.h"
+#include "Event.h"
+#include "Profile.h"
+#include "Trace.h"
 //#include "ringringBuffer.h"
 
 #define SPI_BUFFER_SIZE 64
@@ -17,6 +22,11 @@
 #define SPI2_INTERRUPT_ENABLE 0
 #define SPI3_INTERRUPT_ENABLE 0
 
+// set value as 1 to receive NSS framed slave transfers through DMA
+// (SPI1: NSS on PA4/EXTI4, SPI2: NSS on PB12/EXTI15_10)
+#define SPI1_SLAVE_FRAME_ENABLE 0
+#define SPI2_SLAVE_FRAME_ENABLE 1
+
 // use SPIx_Buff to create ring buffer
 // ex: (in main code)
 // ringBuffer_Typedef SPI1_Buff;
@@ -67,6 +77,14 @@ enum Baud_Rate_Prescaler
     PRE_256
 };
 
+// use declared enum to read SPI block transfer status
+enum SPI_status
+{
+    SPI_OK,
+    SPI_CRC_ERROR,
+    SPI_ERROR_CRC_MODE                      // SPI_init: CRCenable on an SPIx_INTERRUPT_ENABLE instance
+};
+
 // use declared struct to configure SPI function
 typedef struct
 {
@@ -78,13 +96,42 @@ typedef struct
     uint8_t dataFrameFormat;
     uint8_t softwareNSS;
     uint8_t NSSactiveHigh;
+    uint8_t CRCenable;                      // 1: CRC appended/checked at the end of each block or slave frame
+    uint16_t CRCpolynomial;                 // CRC polynomial (0: reset value 0x07)
 }SPIconfig_Typedef;
 
+// called from the NSS rising edge interrupt with the received frame
+typedef void (*SPI_FrameCallback_Typedef)(uint8_t* frame, uint16_t length);
+
+// use declared struct to describe a slave frame receiver
+// ex: (in main code)
+// SPI_SlaveFrame_Typedef SPI2_Frame = { .rxBuffer = buff, .rxSize = sizeof(buff), .frameReceived = onFrame };
+typedef struct
+{
+    uint8_t* rxBuffer;                      // Frame reception buffer
+    uint16_t rxSize;                        // Maximum frame length in bytes
+    const uint8_t* txBuffer;                // Response clocked out during the frame (NULL: 0xFF filler)
+    uint16_t txLength;                      // Response length in bytes
+    SPI_FrameCallback_Typedef frameReceived;
+    Event_Handler frameEvent;               // Posted to the event loop with the frame length (optional)
+    volatile uint32_t frameCount;           // Frames delivered so far
+    volatile uint32_t overflowCount;        // Frames longer than rxSize (truncated)
+    volatile uint32_t crcErrorCount;        // Frames whose last byte is not their CRC (CRCenable only)
+}SPI_SlaveFrame_Typedef;
+
 // function declaration
-void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig);
+uint8_t SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig);
 void SPI_Enable(SPI_TypeDef* SPI);
 void SPI_Disable(SPI_TypeDef* SPI);
+void SPI_SetPrescaler(SPI_TypeDef* SPI, uint8_t baudRatePrescaler);
+uint8_t SPI_GetPrescaler(SPI_TypeDef* SPI, uint32_t maxFrequency);
 void SPI_Write(SPI_TypeDef* SPI, uint16_t data);
 uint16_t SPI_Read(SPI_TypeDef* SPI);
+uint8_t SPI_TransferBlock(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length);
+uint8_t SPI_TransferBlock_DMA(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length);
+uint8_t SPI_CRC8(uint8_t polynomial, const uint8_t* data, uint16_t length);
+
+void SPI_SlaveFrame_init(SPI_TypeDef* SPI, SPI_SlaveFrame_Typedef* frame);
+void SPI_SlaveFrame_SetResponse(SPI_TypeDef* SPI, const uint8_t* txBuffer, uint16_t txLength);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef SPI_FLASH_H_
+#define SPI_FLASH_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "SPI.h"
+
+// W25Qxx geometry
+#define SPIFLASH_PAGE_SIZE      256
+#define SPIFLASH_SECTOR_4K      0x1000
+#define SPIFLASH_BLOCK_32K      0x8000
+#define SPIFLASH_BLOCK_64K      0x10000
+
+// reads and page programs at least this long are moved by DMA
+#define SPIFLASH_DMA_THRESHOLD  32
+
+// use declared enum to read flash operation status
+enum SPIFlash_status
+{
+    SPIFLASH_OK,
+    SPIFLASH_NOT_FOUND,
+    SPIFLASH_OUT_OF_RANGE
+};
+
+// throughput accounting, cleared by SPIFlash_init
+typedef struct
+{
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+    uint32_t bytesErased;
+    uint32_t pagePrograms;
+    uint32_t erase4K;
+    uint32_t erase32K;
+    uint32_t erase64K;
+    uint32_t busyPolls;                 // Status register reads that found WIP set
+}SPIFlash_Stats_Typedef;
+
+// use declared struct to describe a flash chip
+// ex: (in main code)
+// SPIFlash_Typedef flash = { .SPI = SPI1, .csPort = GPIOA, .csPin = 4 };
+typedef struct
+{
+    SPI_TypeDef* SPI;                   // SPI master, software NSS, 8-bit, mode 0 or 3
+    GPIO_TypeDef* csPort;               // Chip select port
+    uint8_t csPin;                      // Chip select pin number
+    uint32_t capacity;                  // Size in bytes (read from JEDEC ID by SPIFlash_init)
+    uint32_t jedecID;                   // Manufacturer, memory type, capacity
+    uint8_t busy;                       // Program/erase issued, WIP not checked yet
+    SPIFlash_Stats_Typedef stats;
+}SPIFlash_Typedef;
+
+// function declaration
+uint8_t SPIFlash_init(SPIFlash_Typedef* flash);
+uint8_t SPIFlash_Read(SPIFlash_Typedef* flash, uint32_t address, uint8_t* data, uint32_t length);
+uint8_t SPIFlash_Write(SPIFlash_Typedef* flash, uint32_t address, const uint8_t* data, uint32_t length);
+uint8_t SPIFlash_Erase(SPIFlash_Typedef* flash, uint32_t address, uint32_t length);
+uint8_t SPIFlash_IsBusy(SPIFlash_Typedef* flash);
+void SPIFlash_WaitReady(SPIFlash_Typedef* flash);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TIME_H_
+#define TIME_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "Clock.h"
+#include "Profile.h"
+
+// set value as 1 to measure the share of time spent asleep in Time_sleepUntil (Time_sleepPercent)
+#define TIME_SLEEP_STATS 1
+
+// use declared enum to select a Time_alarm slot (TIM5 compare channels 2 to 4; channel 1 wakes
+// Time_sleepUntil)
+enum Time_alarm
+{
+    TIME_ALARM_CH2,
+    TIME_ALARM_CH3,
+    TIME_ALARM_CH4,
+    TIME_ALARM_COUNT
+};
+
+// Time_sleepUntil/Time_sleepUntilWake sleep in thread mode; called from an interrupt they spin
+// until the deadline instead (TIM5 channel 1 is a single wake source)
+
+// function declaration
+void Time_init(void);
+uint32_t Time_now_us(void);
+uint64_t Time_now_us64(void);
+uint32_t Time_elapsed_us(uint32_t since);
+uint32_t Time_deadline_us(uint32_t us);
+uint8_t Time_expired(uint32_t deadline);
+void Time_sleepUntil(uint32_t deadline);
+void Time_sleepUntilWake(uint32_t deadline, uint8_t (*wake)(void));
+void Time_alarm(uint8_t alarm, uint32_t deadline, void (*callback)(void));
+void Time_alarmCancel(uint8_t alarm);
+#if TIME_SLEEP_STATS
+uint8_t Time_sleepPercent(void);
+uint64_t Time_sleepTotal_us(void);
+#endif
+
+#endif
@@ -2,6 +2,10 @@
 #define BSP_H_
 
 #include "stm32f401xc.h"
+#include "Clock.h"
+#include "Event.h"
+#include "Profile.h"
+#include "Trace.h"
 //#include "ringBuffer.h"
 
 // macros contains UART address
@@ -39,7 +43,6 @@ enum UART_mode
 typedef struct 
 {
     uint32_t baudRate;
-    uint32_t peripheralClock;
     uint8_t mode;
     uint8_t ParityEnable;
     uint8_t Parity;
@@ -52,6 +55,7 @@ void UART_Write(USART_TypeDef* UART, uint8_t Tx_data);
 void UART_EnableInterrupts(USART_TypeDef* UART);
 void UART_EnableInterrupts_Tx(USART_TypeDef* UART);
 void UART_EnableInterrupts_Rx(USART_TypeDef* UART);
+void UART_SetRxEvent(USART_TypeDef* UART, Event_Handler handler);
 
 uint8_t UART_Read(USART_TypeDef* UART);
 
@@ -1,6 +1,16 @@
 #include "stm32f401xc.h"
+#include "Clock.h"
+#include "Time.h"
+#include "Event.h"
+#include "Task.h"
+#include "Profile.h"
+#include "Load.h"
+#include "Trace.h"
 #include "SPI.h"
 #include "UART.h"
+#include "I2S.h"
 
 extern void SystemInit(void);
-extern void Delay_ms(uint16_t ms);
\ No newline at end of file
+extern void Delay_us(uint32_t us);
+extern void Delay_ms(uint32_t ms);
+extern void SysClockConfig_PLLI2S(uint16_t plli2sn, uint8_t plli2sr);
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "I2S.h"
+#include "SPI.h"
+
+// I2S2 streams on DMA1 Stream3/4, the same streams the SPI2 slave frame engine uses
+#if I2S2_STREAM_ENABLE && SPI2_SLAVE_FRAME_ENABLE
+#error "I2S2_STREAM_ENABLE takes DMA1 Stream3/4 from SPI2_SLAVE_FRAME_ENABLE, enable only one"
+#endif
+
+// DMA streams serving each I2S instance (RM0368 DMA1 request mapping, channel 0)
+typedef struct
+{
+    SPI_TypeDef* I2S;
+    DMA_Stream_TypeDef* txStream;
+    DMA_Stream_TypeDef* rxStream;
+    IRQn_Type txIRQ;
+    IRQn_Type rxIRQ;
+    uint8_t enabled;                // Stream handlers compiled in (I2Sx_STREAM_ENABLE)
+}I2S_DMA_Typedef;
+
+static const I2S_DMA_Typedef i2sDMA[2] = {
+    { SPI2, DMA1_Stream4, DMA1_Stream3, DMA1_Stream4_IRQn, DMA1_Stream3_IRQn, I2S2_STREAM_ENABLE },
+    { SPI3, DMA1_Stream5, DMA1_Stream0, DMA1_Stream5_IRQn, DMA1_Stream0_IRQn, I2S3_STREAM_ENABLE }
+};
+
+static I2S_Stream_Typedef* i2sStream[2];
+
+/**
+ * @brief  Returns the slot of the given I2S instance, or -1 if not supported.
+ */
+static int8_t I2S_Index(SPI_TypeDef* I2S)
+{
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (i2sDMA[i].I2S == I2S)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  Returns 1 if the instance is configured as a transmitter.
+ */
+static uint8_t I2S_IsTx(SPI_TypeDef* I2S)
+{
+    uint8_t mode = (I2S->I2SCFGR & SPI_I2SCFGR_I2SCFG) >> SPI_I2SCFGR_I2SCFG_Pos;
+    return (mode == I2S_SLAVE_TX || mode == I2S_MASTER_TX);
+}
+
+/*************************************** Setup I2S ********************************************
+ * @brief  Configures SPI2/SPI3 in I2S mode and computes the clock divider for sampleRate.
+ *
+ * @param  I2S: Pointer to SPI peripheral used as I2S (SPI2, SPI3)
+ * @param  I2Sconfig: Pointer to configuration structure
+ * @return Sample rate actually produced (master modes), 0 if the divider is out of range
+ * @note   PLLI2S must be running (SysClockConfig_PLLI2S) before a master mode is configured.
+ *         I2S pins are configured by the application (gpioConfig).
+ */
+uint32_t I2S_init(SPI_TypeDef* I2S, I2Sconfig_Typedef* I2Sconfig)
+{
+    uint32_t actualRate = 0;
+
+    // Enable the appropriate SPI peripheral clock
+    if ((void*)I2S == (void*)SPI2)
+    {
+        RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+    }
+    else if ((void*)I2S == (void*)SPI3)
+    {
+        RCC->APB1ENR |= RCC_APB1ENR_SPI3EN;
+    }
+
+    RCC->CFGR &= ~RCC_CFGR_I2SSRC;                  // I2S kernel clock from PLLI2S
+
+    // Disable I2S before configuration
+    I2S->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+
+    uint32_t cfgr = SPI_I2SCFGR_I2SMOD                              // I2S mode
+                  | ((uint32_t)I2Sconfig->mode << SPI_I2SCFGR_I2SCFG_Pos)
+                  | ((uint32_t)I2Sconfig->standard << SPI_I2SCFGR_I2SSTD_Pos);
+
+    // Data and channel length
+    switch (I2Sconfig->dataFormat)
+    {
+        case I2S_16BIT:             break;                                          // DATLEN 00, CHLEN 0
+        case I2S_16BIT_EXTENDED:    cfgr |= SPI_I2SCFGR_CHLEN;                      // DATLEN 00, CHLEN 1
+                                    break;
+        case I2S_24BIT:             cfgr |= SPI_I2SCFGR_CHLEN | SPI_I2SCFGR_DATLEN_0;
+                                    break;
+        case I2S_32BIT:             cfgr |= SPI_I2SCFGR_CHLEN | SPI_I2SCFGR_DATLEN_1;
+                                    break;
+    }
+
+    if (I2Sconfig->CPOL)
+    {
+        cfgr |= SPI_I2SCFGR_CKPOL;                  // Clock idle high
+    }
+
+    I2S->I2SCFGR = cfgr;
+
+    // Clock divider (master modes only)
+    if (I2Sconfig->mode == I2S_MASTER_TX || I2Sconfig->mode == I2S_MASTER_RX)
+    {
+        uint32_t n = (RCC->PLLI2SCFGR & RCC_PLLI2SCFGR_PLLI2SN) >> RCC_PLLI2SCFGR_PLLI2SN_Pos;
+        uint32_t r = (RCC->PLLI2SCFGR & RCC_PLLI2SCFGR_PLLI2SR) >> RCC_PLLI2SCFGR_PLLI2SR_Pos;
+        uint32_t i2sClk = (r) ? (I2S_PLL_INPUT_CLK * n) / r : 0;
+
+        // Fs = I2SxCLK / (bitsPerFrame * (2 * I2SDIV + ODD)), 256 x Fs when MCK is output
+        uint32_t bitsPerFrame = I2Sconfig->MCLKoutput ? 256 : ((cfgr & SPI_I2SCFGR_CHLEN) ? 64 : 32);
+        uint32_t divider = (I2Sconfig->sampleRate) ?
+                           ((i2sClk * 10) / (bitsPerFrame * I2Sconfig->sampleRate) + 5) / 10 : 0;   // Rounded
+
+        if (divider < 4 || divider > 511)
+        {
+            return 0;                               // I2SDIV must be 2..255
+        }
+
+        I2S->I2SPR = ((divider >> 1) << SPI_I2SPR_I2SDIV_Pos)
+                   | ((divider & 1) << SPI_I2SPR_ODD_Pos)
+                   | (I2Sconfig->MCLKoutput ? SPI_I2SPR_MCKOE : 0);
+
+        actualRate = i2sClk / (bitsPerFrame * divider);
+    }
+
+    return actualRate;
+}
+
+/************************************** Stream control ****************************************
+ * @brief  Starts circular DMA streaming through stream->buffer. The half/full callbacks run
+ *         in the DMA interrupt: the application refills (TX) or consumes (RX) one half while
+ *         the hardware plays or records the other.
+ *
+ * @param  I2S: Pointer to SPI peripheral used as I2S (SPI2, SPI3)
+ * @param  stream: Pointer to stream descriptor (must stay valid while streaming)
+ * @return I2S_OK, or I2S_ERROR if the instance has no stream interrupt handlers
+ *         (I2Sx_STREAM_ENABLE 0: the DMA interrupt would hit Default_Handler)
+ * @note   For TX, prefill the whole buffer before starting.
+ */
+uint8_t I2S_StartStream(SPI_TypeDef* I2S, I2S_Stream_Typedef* stream)
+{
+    int8_t index = I2S_Index(I2S);
+    if (index < 0 || !i2sDMA[index].enabled)
+    {
+        return I2S_ERROR;
+    }
+    const I2S_DMA_Typedef* dma = &i2sDMA[index];
+    uint8_t tx = I2S_IsTx(I2S);
+
+    i2sStream[index] = stream;
+    stream->errorCount = 0;
+
+    DMA_Config_Typedef dmaConfig = {
+        .channel = 0,
+        .direction = tx ? DMA_MEM_TO_PERIPH : DMA_PERIPH_TO_MEM,
+        .dataSize = DMA_SIZE_16,                    // DR is 16-bit, 24/32-bit samples take two items
+        .memIncrement = 1,
+        .circular = 1,
+        .priority = 3,                              // Audio must never starve
+        .interruptTC = 1,
+        .interruptHT = 1
+    };
+    DMA_Stream_TypeDef* dmaStream = tx ? dma->txStream : dma->rxStream;
+    DMA_init(dmaStream, &dmaConfig);
+
+    __disable_irq();
+    NVIC_EnableIRQ(tx ? dma->txIRQ : dma->rxIRQ);
+    __enable_irq();
+
+    DMA_Start(dmaStream, &I2S->DR, stream->buffer, stream->length);
+    I2S->CR2 |= tx ? SPI_CR2_TXDMAEN : SPI_CR2_RXDMAEN;
+    I2S->I2SCFGR |= SPI_I2SCFGR_I2SE;               // Start clocking
+
+    return I2S_OK;
+}
+
+/**
+ * @brief  Stops a stream following the I2S disable procedure: the DMA is detached first so
+ *         nothing refills DR, then for TX the last sample is let out before I2SE is cleared.
+ */
+void I2S_StopStream(SPI_TypeDef* I2S)
+{
+    int8_t index = I2S_Index(I2S);
+    if (index < 0)
+    {
+        return;
+    }
+    const I2S_DMA_Typedef* dma = &i2sDMA[index];
+
+    I2S->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+    DMA_Stop(dma->txStream);
+    DMA_Stop(dma->rxStream);
+
+    if (I2S_IsTx(I2S))
+    {
+        while (!(I2S->SR & SPI_SR_TXE));            // Last sample moved to the shift register
+        while (I2S->SR & SPI_SR_BSY);               // and shifted out
+    }
+    I2S->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    i2sStream[index] = 0;
+}
+
+/****************************************** ISR ***********************************************
+ * @brief  DMA half/full transfer interrupts of the streaming instances.
+ */
+static void I2S_DMA_IRQHandler(uint8_t index, DMA_Stream_TypeDef* dmaStream)
+{
+    I2S_Stream_Typedef* stream = i2sStream[index];
+    uint8_t flags = DMA_GetFlags(dmaStream);
+    uint16_t half = stream ? (stream->length / 2) : 0;
+
+    DMA_ClearFlags(dmaStream, flags);
+
+    if (stream == 0)
+    {
+        return;
+    }
+    if (flags & DMA_FLAG_TE)
+    {
+        stream->errorCount++;
+    }
+    if ((flags & DMA_FLAG_HT) && stream->halfCallback)
+    {
+        stream->halfCallback(stream->buffer, half);             // First half released
+    }
+    if ((flags & DMA_FLAG_TC) && stream->fullCallback)
+    {
+        stream->fullCallback(stream->buffer + half, half);      // Second half released
+    }
+}
+
+#if I2S2_STREAM_ENABLE
+void DMA1_Stream4_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2S_DMA_IRQHandler(0, DMA1_Stream4);
+    PROFILE_ISR_EXIT(PROFILE_I2S2_DMA);
+}
+
+void DMA1_Stream3_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2S_DMA_IRQHandler(0, DMA1_Stream3);
+    PROFILE_ISR_EXIT(PROFILE_I2S2_DMA);
+}
+#endif
+
+#if I2S3_STREAM_ENABLE
+void DMA1_Stream5_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2S_DMA_IRQHandler(1, DMA1_Stream5);
+    PROFILE_ISR_EXIT(PROFILE_I2S3_DMA);
+}
+
+void DMA1_Stream0_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    I2S_DMA_IRQHandler(1, DMA1_Stream0);
+    PROFILE_ISR_EXIT(PROFILE_I2S3_DMA);
+}
+#endif
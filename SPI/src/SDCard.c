@@ -0,0 +1,464 @@
+#include "SDCard.h"
+
+// SD commands used in SPI mode
+#define CMD0        0       // GO_IDLE_STATE
+#define CMD8        8       // SEND_IF_COND
+#define CMD9        9       // SEND_CSD
+#define CMD12       12      // STOP_TRANSMISSION
+#define CMD16       16      // SET_BLOCKLEN
+#define CMD17       17      // READ_SINGLE_BLOCK
+#define CMD18       18      // READ_MULTIPLE_BLOCK
+#define CMD24       24      // WRITE_BLOCK
+#define CMD25       25      // WRITE_MULTIPLE_BLOCK
+#define CMD55       55      // APP_CMD
+#define CMD58       58      // READ_OCR
+#define ACMD23      23      // SET_WR_BLK_ERASE_COUNT (pre-erase for multi-block writes)
+#define ACMD41      41      // SD_SEND_OP_COND
+
+// data tokens
+#define TOKEN_START_BLOCK       0xFE    // Single block read/write, multi-block read
+#define TOKEN_START_MULTI_WRITE 0xFC
+#define TOKEN_STOP_MULTI_WRITE  0xFD
+#define DATA_RESPONSE_MASK      0x1F
+#define DATA_ACCEPTED           0x05
+
+#define R1_IDLE                 0x01
+#define OCR_CCS                 0x40000000UL    // Card capacity status (SDHC/SDXC)
+
+// retry budgets, counted in bytes clocked at the identification/data rate
+#define INIT_RETRIES            4000    // ACMD41 loop (CMD55 + ACMD41), about 1.5 s at 328 kHz
+#define TOKEN_RETRIES           50000   // Read token wait, about 100 ms at 21 MHz
+#define BUSY_RETRIES            500000  // Program/erase busy wait, about 250 ms at 21 MHz
+
+/*********************************** Low level helpers ****************************************/
+static uint8_t SDCard_Xfer(SDCard_Typedef* card, uint8_t data)
+{
+    uint8_t rx;
+    SPI_TransferBlock(card->SPI, &data, &rx, 1);
+    return rx;
+}
+
+static void SDCard_Select(SDCard_Typedef* card)
+{
+    card->csPort->BSRR = 1U << (card->csPin + 16);      // CS low
+    SDCard_Xfer(card, 0xFF);                            // Give the card a clock to see it
+}
+
+static void SDCard_Deselect(SDCard_Typedef* card)
+{
+    card->csPort->BSRR = 1U << card->csPin;             // CS high
+    SDCard_Xfer(card, 0xFF);                            // Card releases MISO on the next clock
+}
+
+/**
+ * @brief  Waits until the card releases MISO (0xFF) after a program or stop.
+ * @return 1 if ready, 0 on timeout
+ */
+static uint8_t SDCard_WaitReady(SDCard_Typedef* card)
+{
+    for (uint32_t i = 0; i < BUSY_RETRIES; i++)
+    {
+        if (SDCard_Xfer(card, 0xFF) == 0xFF)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Sends a command frame and returns the R1 response (0xFF when the card is silent).
+ *         Chip select must already be low.
+ */
+static uint8_t SDCard_Command(SDCard_Typedef* card, uint8_t command, uint32_t argument)
+{
+    uint8_t frame[6];
+    uint8_t response = 0xFF;
+
+    if (command == ACMD23 || command == ACMD41)
+    {
+        response = SDCard_Command(card, CMD55, 0);      // Application command prefix
+        if (response > R1_IDLE)
+        {
+            return response;
+        }
+    }
+
+    frame[0] = 0x40 | command;
+    frame[1] = argument >> 24;
+    frame[2] = argument >> 16;
+    frame[3] = argument >> 8;
+    frame[4] = argument;
+    frame[5] = (command == CMD0) ? 0x95 : (command == CMD8) ? 0x87 : 0x01;  // CRC only checked for CMD0/CMD8
+    SPI_TransferBlock(card->SPI, frame, 0, 6);
+
+    if (command == CMD12)
+    {
+        SDCard_Xfer(card, 0xFF);                        // Skip the stuff byte
+    }
+
+    for (uint8_t i = 0; i < 8; i++)                     // Response within NCR (8 bytes)
+    {
+        response = SDCard_Xfer(card, 0xFF);
+        if (!(response & 0x80))
+        {
+            break;
+        }
+    }
+    return response;
+}
+
+/**
+ * @brief  Receives one data block (token, payload, CRC).
+ * @return 1 on success, 0 on timeout or error token
+ */
+static uint8_t SDCard_ReceiveBlock(SDCard_Typedef* card, uint8_t* data, uint16_t length)
+{
+    uint8_t token = 0xFF;
+
+    for (uint32_t i = 0; i < TOKEN_RETRIES && token == 0xFF; i++)
+    {
+        token = SDCard_Xfer(card, 0xFF);
+    }
+    if (token != TOKEN_START_BLOCK)
+    {
+        return 0;
+    }
+
+    SPI_TransferBlock_DMA(card->SPI, 0, data, length);  // Payload clocked in by DMA
+    SDCard_Xfer(card, 0xFF);                            // CRC (not checked in SPI mode)
+    SDCard_Xfer(card, 0xFF);
+    return 1;
+}
+
+/**
+ * @brief  Sends one data block with the given start token and waits for the card to store it.
+ * @return 1 if accepted, 0 otherwise
+ */
+static uint8_t SDCard_SendBlock(SDCard_Typedef* card, const uint8_t* data, uint8_t token)
+{
+    SDCard_Xfer(card, token);
+    SPI_TransferBlock_DMA(card->SPI, data, 0, SDCARD_SECTOR_SIZE);  // Payload clocked out by DMA
+    SDCard_Xfer(card, 0xFF);                            // Dummy CRC
+    SDCard_Xfer(card, 0xFF);
+
+    if ((SDCard_Xfer(card, 0xFF) & DATA_RESPONSE_MASK) != DATA_ACCEPTED)
+    {
+        return 0;
+    }
+    return SDCard_WaitReady(card);                      // Card holds MISO low while programming
+}
+
+/**
+ * @brief  Checks that count sectors from sector exist on the card (count 0 is refused).
+ */
+static uint8_t SDCard_InRange(SDCard_Typedef* card, uint32_t sector, uint32_t count)
+{
+    return count != 0 && sector < card->sectorCount && count <= card->sectorCount - sector;
+}
+
+/**
+ * @brief  Reads the CSD register and derives the number of 512-byte sectors.
+ */
+static uint32_t SDCard_ReadCapacity(SDCard_Typedef* card)
+{
+    uint8_t csd[16];
+
+    if (SDCard_Command(card, CMD9, 0) != 0 || !SDCard_ReceiveBlock(card, csd, 16))
+    {
+        return 0;
+    }
+
+    if ((csd[0] >> 6) == 1)                             // CSD version 2.0 (SDHC/SDXC)
+    {
+        uint32_t cSize = ((uint32_t)(csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
+        return (cSize + 1) * 1024;
+    }
+
+    // CSD version 1.0 (SDSC)
+    uint32_t readBlLen = csd[5] & 0x0F;
+    uint32_t cSize = ((uint32_t)(csd[6] & 0x03) << 10) | ((uint32_t)csd[7] << 2) | (csd[8] >> 6);
+    uint32_t cSizeMult = ((csd[9] & 0x03) << 1) | (csd[10] >> 7);
+    return ((cSize + 1) << (cSizeMult + 2 + readBlLen)) / SDCARD_SECTOR_SIZE;
+}
+
+/************************************** Setup SD card *****************************************
+ * @brief  Identifies the card at low clock (CMD0, CMD8, ACMD41, CMD58), reads its capacity
+ *         and switches the SPI to SDCARD_FAST_FREQ.
+ *
+ * @param  card: Pointer to card descriptor (SPI, csPort and csPin filled in)
+ * @return SD_OK, SD_NO_CARD, SD_UNSUPPORTED or SD_TIMEOUT
+ * @note   The SPI must be initialized as master with software NSS before this call.
+ */
+uint8_t SDCard_init(SDCard_Typedef* card)
+{
+    uint8_t status = SD_OK;
+    uint8_t r7[4];
+
+    card->type = SD_TYPE_NONE;
+    card->sectorCount = 0;
+
+    // Chip select as push-pull output, idle high
+    RCC->AHB1ENR |= 1U << (((uint32_t)card->csPort - GPIOA_BASE) / 0x400U);
+    card->csPort->BSRR = 1U << card->csPin;
+    card->csPort->MODER &= ~(3U << (card->csPin * 2));
+    card->csPort->MODER |= (1U << (card->csPin * 2));
+    card->csPort->OSPEEDR |= (3U << (card->csPin * 2));
+
+    SPI_SetPrescaler(card->SPI, SPI_GetPrescaler(card->SPI, SDCARD_INIT_FREQ));
+    SPI_Enable(card->SPI);
+
+    for (uint8_t i = 0; i < 10; i++)                    // 80 clocks with CS high: enter SPI mode
+    {
+        SDCard_Xfer(card, 0xFF);
+    }
+
+    SDCard_Select(card);
+
+    if (SDCard_Command(card, CMD0, 0) != R1_IDLE)
+    {
+        SDCard_Deselect(card);
+        return SD_NO_CARD;
+    }
+
+    uint32_t acmd41Arg = 0;
+    if (SDCard_Command(card, CMD8, 0x1AA) == R1_IDLE)   // Version 2.00 or later card
+    {
+        SPI_TransferBlock(card->SPI, 0, r7, 4);
+        if (r7[2] != 0x01 || r7[3] != 0xAA)
+        {
+            SDCard_Deselect(card);
+            return SD_UNSUPPORTED;                      // Voltage range not accepted
+        }
+        card->type = SD_TYPE_SDSC_V2;
+        acmd41Arg = OCR_CCS;                            // Host supports high capacity
+    }
+    else
+    {
+        card->type = SD_TYPE_SDSC_V1;
+    }
+
+    uint8_t response = 0xFF;
+    for (uint32_t i = 0; i < INIT_RETRIES && response != 0; i++)
+    {
+        response = SDCard_Command(card, ACMD41, acmd41Arg);
+    }
+    if (response != 0)
+    {
+        card->type = SD_TYPE_NONE;
+        SDCard_Deselect(card);
+        return SD_TIMEOUT;
+    }
+
+    if (card->type == SD_TYPE_SDSC_V2 && SDCard_Command(card, CMD58, 0) == 0)
+    {
+        uint8_t ocr[4];
+        SPI_TransferBlock(card->SPI, 0, ocr, 4);
+        if (ocr[0] & (OCR_CCS >> 24))
+        {
+            card->type = SD_TYPE_SDHC;                  // Block addressed
+        }
+    }
+
+    if (card->type != SD_TYPE_SDHC && SDCard_Command(card, CMD16, SDCARD_SECTOR_SIZE) != 0)
+    {
+        status = SD_UNSUPPORTED;                        // Byte addressed card refuses 512-byte blocks
+    }
+
+    SDCard_Deselect(card);
+
+    SPI_SetPrescaler(card->SPI, SPI_GetPrescaler(card->SPI, SDCARD_FAST_FREQ));   // Identification done, full speed from here
+
+    if (status == SD_OK)
+    {
+        SDCard_Select(card);
+        card->sectorCount = SDCard_ReadCapacity(card);
+        SDCard_Deselect(card);
+    }
+
+    return status;
+}
+
+/************************************** Read sectors ******************************************
+ * @brief  Reads consecutive sectors, with CMD18 multi-block read when count > 1.
+ *
+ * @param  card: Pointer to card descriptor
+ * @param  sector: First sector (LBA)
+ * @param  data: Destination buffer (count * 512 bytes)
+ * @param  count: Number of sectors
+ * @return SD_OK, SD_READ_ERROR, SD_NO_CARD, or SD_BAD_ARGUMENT if count is 0 or the range
+ *         does not fit the card
+ */
+uint8_t SDCard_ReadSectors(SDCard_Typedef* card, uint32_t sector, uint8_t* data, uint32_t count)
+{
+    uint8_t status = SD_OK;
+
+    if (card->type == SD_TYPE_NONE)
+    {
+        return SD_NO_CARD;
+    }
+    if (!SDCard_InRange(card, sector, count))
+    {
+        return SD_BAD_ARGUMENT;
+    }
+    if (card->type != SD_TYPE_SDHC)
+    {
+        sector *= SDCARD_SECTOR_SIZE;                   // SDSC is byte addressed
+    }
+
+    SDCard_Select(card);
+
+    if (SDCard_Command(card, (count > 1) ? CMD18 : CMD17, sector) != 0)
+    {
+        status = SD_READ_ERROR;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (!SDCard_ReceiveBlock(card, data, SDCARD_SECTOR_SIZE))
+            {
+                status = SD_READ_ERROR;
+                break;
+            }
+            data += SDCARD_SECTOR_SIZE;
+        }
+
+        if (count > 1)
+        {
+            SDCard_Command(card, CMD12, 0);             // Stop the stream
+            SDCard_WaitReady(card);
+        }
+    }
+
+    SDCard_Deselect(card);
+    return status;
+}
+
+/************************************* Write sectors ******************************************
+ * @brief  Writes consecutive sectors, with ACMD23 pre-erase and CMD25 multi-block write
+ *         when count > 1.
+ *
+ * @param  card: Pointer to card descriptor
+ * @param  sector: First sector (LBA)
+ * @param  data: Source buffer (count * 512 bytes)
+ * @param  count: Number of sectors
+ * @return SD_OK, SD_WRITE_ERROR, SD_NO_CARD, or SD_BAD_ARGUMENT if count is 0 or the range
+ *         does not fit the card
+ */
+uint8_t SDCard_WriteSectors(SDCard_Typedef* card, uint32_t sector, const uint8_t* data, uint32_t count)
+{
+    uint8_t status = SD_OK;
+
+    if (card->type == SD_TYPE_NONE)
+    {
+        return SD_NO_CARD;
+    }
+    if (!SDCard_InRange(card, sector, count))
+    {
+        return SD_BAD_ARGUMENT;
+    }
+    if (card->type != SD_TYPE_SDHC)
+    {
+        sector *= SDCARD_SECTOR_SIZE;
+    }
+
+    SDCard_Select(card);
+
+    if (count == 1)
+    {
+        if (SDCard_Command(card, CMD24, sector) != 0 || !SDCard_SendBlock(card, data, TOKEN_START_BLOCK))
+        {
+            status = SD_WRITE_ERROR;
+        }
+    }
+    else
+    {
+        SDCard_Command(card, ACMD23, count);            // Optional hint, lets the card pre-erase
+
+        if (SDCard_Command(card, CMD25, sector) != 0)
+        {
+            status = SD_WRITE_ERROR;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (!SDCard_SendBlock(card, data, TOKEN_START_MULTI_WRITE))
+                {
+                    status = SD_WRITE_ERROR;
+                    break;
+                }
+                data += SDCARD_SECTOR_SIZE;
+            }
+
+            SDCard_Xfer(card, TOKEN_STOP_MULTI_WRITE);  // End of stream
+            SDCard_Xfer(card, 0xFF);
+            if (!SDCard_WaitReady(card))
+            {
+                status = SD_WRITE_ERROR;
+            }
+        }
+    }
+
+    SDCard_Deselect(card);
+    return status;
+}
+
+/*********************************** Throughput benchmark *************************************
+ * @brief  Measures sequential write then read throughput using the DWT cycle counter.
+ *         Destroys the content of the tested sectors.
+ *
+ * @param  card: Pointer to initialized card descriptor
+ * @param  sector: First sector of the test area
+ * @param  buffer: Scratch buffer of bufferSectors * 512 bytes (transfer unit)
+ * @param  bufferSectors: Sectors moved per command (at least 1, else SD_BAD_ARGUMENT)
+ * @param  totalSectors: Size of the test area in sectors
+ * @param  result: Measured bytes per second and status
+ * @note   Runs must be shorter than 2^32 core cycles (about 51 s at 84 MHz).
+ */
+void SDCard_Benchmark(SDCard_Typedef* card, uint32_t sector, uint8_t* buffer, uint32_t bufferSectors,
+                      uint32_t totalSectors, SDCard_Bench_Typedef* result)
+{
+    uint32_t coreClock = SystemCoreClock;               // Cycle counter rate
+    uint64_t bytes = (uint64_t)totalSectors * SDCARD_SECTOR_SIZE;
+    uint32_t start, cycles;
+
+    result->writeBytesPerSec = 0;
+    result->readBytesPerSec = 0;
+    result->status = SD_OK;
+    if (bufferSectors == 0)
+    {
+        result->status = SD_BAD_ARGUMENT;               // The loops below would never advance
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // Enable DWT
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // Start cycle counter
+
+    start = DWT->CYCCNT;
+    for (uint32_t done = 0; done < totalSectors && result->status == SD_OK; done += bufferSectors)
+    {
+        uint32_t count = (totalSectors - done < bufferSectors) ? (totalSectors - done) : bufferSectors;
+        result->status = SDCard_WriteSectors(card, sector + done, buffer, count);
+    }
+    cycles = DWT->CYCCNT - start;
+    if (result->status != SD_OK || cycles == 0)
+    {
+        return;
+    }
+    result->writeBytesPerSec = (bytes * coreClock) / cycles;
+
+    start = DWT->CYCCNT;
+    for (uint32_t done = 0; done < totalSectors && result->status == SD_OK; done += bufferSectors)
+    {
+        uint32_t count = (totalSectors - done < bufferSectors) ? (totalSectors - done) : bufferSectors;
+        result->status = SDCard_ReadSectors(card, sector + done, buffer, count);
+    }
+    cycles = DWT->CYCCNT - start;
+    if (result->status != SD_OK || cycles == 0)
+    {
+        return;
+    }
+    result->readBytesPerSec = (bytes * coreClock) / cycles;
+}
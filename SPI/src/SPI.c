@@ -1,19 +1,100 @@
 #include "SPI.h"
 
+// DMA streams serving each SPI (RM0368 DMA1/DMA2 request mapping)
+typedef struct
+{
+    SPI_TypeDef* SPI;
+    DMA_Stream_TypeDef* rxStream;
+    DMA_Stream_TypeDef* txStream;
+    uint8_t channel;
+}SPI_DMA_Typedef;
+
+static const SPI_DMA_Typedef spiDMA[3] = {
+    { SPI1, DMA2_Stream0, DMA2_Stream3, 3 },
+    { SPI2, DMA1_Stream3, DMA1_Stream4, 0 },
+    { SPI3, DMA1_Stream0, DMA1_Stream5, 0 }
+};
+
+static const uint8_t dummyTx = 0xFF;        // Filler clocked out when there is nothing to send
+static uint8_t dummyRx;                     // Sink for received data nobody asked for
+
+static uint32_t spiFrequency[3];            // SCK of each master (0: slave), kept across clock changes
+
+#define SPI_TRACE_SOURCE(SPI)   (TRACE_SPI1 + (SPI_GetDMA(SPI) - spiDMA))
+
+/**
+ * @brief  Returns the DMA streams of the given SPI.
+ */
+static const SPI_DMA_Typedef* SPI_GetDMA(SPI_TypeDef* SPI)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (spiDMA[i].SPI == SPI)
+        {
+            return &spiDMA[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  Writes the baud rate prescaler; BR must not change during a transfer.
+ */
+static void SPI_WriteBR(SPI_TypeDef* SPI, uint8_t baudRatePrescaler)
+{
+    uint32_t enabled = SPI->CR1 & SPI_CR1_SPE;
+
+    SPI_Disable(SPI);
+    SPI->CR1 = (SPI->CR1 & ~SPI_CR1_BR) | ((uint32_t)baudRatePrescaler << SPI_CR1_BR_Pos);
+    SPI->CR1 |= enabled;
+}
+
+/**
+ * @brief  Reclock notification: masters finish the frame in progress, then get the prescaler
+ *         that keeps SCK at or below the rate they ran at before the change.
+ */
+static void SPI_Reclock(uint8_t event)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        SPI_TypeDef* SPI = spiDMA[i].SPI;
+
+        if (!spiFrequency[i])
+        {
+            continue;
+        }
+        if (event == CLOCK_PRE_CHANGE)
+        {
+            while (SPI->SR & SPI_SR_BSY);           // Wait until SPI is not busy
+        }
+        else
+        {
+            SPI_WriteBR(SPI, SPI_GetPrescaler(SPI, spiFrequency[i]));
+        }
+    }
+}
+
 /*************************************** Setup SPI *******************************************
  * @brief  Initializes the SPI peripheral according to the specified parameters in SPIconfig.
  *
  * @param  SPI: Pointer to SPI peripheral (SPI1, SPI2, SPI3)
  * @param  SPIconfig: Pointer to configuration structure
+ * @return SPI_OK, or SPI_ERROR_CRC_MODE if CRCenable is set for an instance served by the
+ *         interrupt ring buffers (CRC left off)
  * @note   Enables peripheral clock, configures mode, data size, NSS, and interrupt settings.
+ *         The ring buffers carry a byte stream with no block end to place the CRC at.
  */
-void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
+uint8_t SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
 {
+    uint8_t status = SPI_OK;
+    uint8_t ringBuffered = 0;                           // SPIx_INTERRUPT_ENABLE of this instance
+
     // Enable the appropriate SPI peripheral clock
     if ((void*)SPI == (void*)SPI1)
     {
         RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;         // Enable SPI1 clock
         #if SPI1_INTERRUPT_ENABLE
+        ringBuffered = 1;
         __disable_irq();                            // Disable global interrupts for safe NVIC config
         NVIC_EnableIRQ(SPI1_IRQn);                  // Enable SPI1 interrupt in NVIC
         __enable_irq();                             // Re-enable global interrupts
@@ -23,6 +104,7 @@ void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
     {
         RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;         // Enable SPI2 clock
         #if SPI2_INTERRUPT_ENABLE
+        ringBuffered = 1;
         __disable_irq();
         NVIC_EnableIRQ(SPI2_IRQn);
         __enable_irq();
@@ -32,6 +114,7 @@ void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
     {
         RCC->APB1ENR |= RCC_APB1ENR_SPI3EN;         // Enable SPI3 clock
         #if SPI3_INTERRUPT_ENABLE
+        ringBuffered = 1;
         __disable_irq();
         NVIC_EnableIRQ(SPI3_IRQn);
         __enable_irq();
@@ -45,6 +128,12 @@ void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
     if (SPIconfig->operationMode)                       // Master mode
     {
         SPI->CR1 |= (SPIconfig->baudRatePrescaler << 3);
+        spiFrequency[SPI_GetDMA(SPI) - spiDMA] = Clock_GetBusClock(SPI) >> (SPIconfig->baudRatePrescaler + 1);
+        Clock_Register(SPI_Reclock);                    // Keep SCK across operating points
+    }
+    else
+    {
+        spiFrequency[SPI_GetDMA(SPI) - spiDMA] = 0;     // Slaves follow the master clock
     }
 
     // Configure data frame format: 8-bit or 16-bit
@@ -57,6 +146,22 @@ void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
         SPI->CR1 &= ~(SPI_CR1_DFF);                     // 8-bit data frame
     }
 
+    // Configure hardware CRC (CRC length follows the data frame format)
+    if (SPIconfig->CRCenable && ringBuffered)
+    {
+        SPI->CR1 &= ~(SPI_CR1_CRCEN);                   // No block end in a byte stream
+        status = SPI_ERROR_CRC_MODE;
+    }
+    else if (SPIconfig->CRCenable)
+    {
+        SPI->CRCPR = SPIconfig->CRCpolynomial ? SPIconfig->CRCpolynomial : 0x07;
+        SPI->CR1 |= SPI_CR1_CRCEN;                      // CRC calculation enabled
+    }
+    else
+    {
+        SPI->CR1 &= ~(SPI_CR1_CRCEN);                   // CRC calculation disabled
+    }
+
     // Set SPI mode (CPOL and CPHA bits)
     SPI->CR1 |= SPIconfig->SPImode;
 
@@ -105,6 +210,8 @@ void SPI_init(SPI_TypeDef* SPI, SPIconfig_Typedef* SPIconfig)
     {
         SPI->CR1 &= ~(SPI_CR1_MSTR);                    // Slave mode
     }
+
+    return status;
 }
 
 /************************************ Enable/Disable SPI **************************************
@@ -122,6 +229,40 @@ void SPI_Disable(SPI_TypeDef* SPI)
     SPI->CR1 &= ~SPI_CR1_SPE;               // Disable SPI (clear SPE bit)
 }
 
+/********************************** Change baud rate ******************************************
+ * @brief  Changes the baud rate prescaler of an initialized master (e.g. slow card
+ *         identification followed by full speed data transfer).
+ *
+ * @param  SPI: Pointer to SPI peripheral
+ * @param  baudRatePrescaler: PRE_2 ... PRE_256
+ * @note   The resulting SCK rate is kept when the operating point changes (Clock.h).
+ */
+void SPI_SetPrescaler(SPI_TypeDef* SPI, uint8_t baudRatePrescaler)
+{
+    SPI_WriteBR(SPI, baudRatePrescaler);
+    spiFrequency[SPI_GetDMA(SPI) - spiDMA] = Clock_GetBusClock(SPI) >> (baudRatePrescaler + 1);
+}
+
+/**
+ * @brief  Smallest prescaler keeping the SPI clock at or below maxFrequency, from the running
+ *         APB clock of the instance (APB2 for SPI1/SPI4, APB1 for SPI2/SPI3).
+ *
+ * @param  SPI: Pointer to SPI peripheral
+ * @param  maxFrequency: Highest allowed SCK frequency in Hz
+ * @return PRE_2 ... PRE_256 (PRE_256 if even that is too fast)
+ */
+uint8_t SPI_GetPrescaler(SPI_TypeDef* SPI, uint32_t maxFrequency)
+{
+    uint32_t busClock = Clock_GetBusClock(SPI);
+    uint8_t prescaler = PRE_2;
+
+    while (prescaler < PRE_256 && (busClock >> (prescaler + 1)) > maxFrequency)
+    {
+        prescaler++;
+    }
+    return prescaler;
+}
+
 /************************************* Transmit data ******************************************
  * @brief  Blocking transmit: Waits until TX buffer is empty, then writes data to SPI.
  *
@@ -146,6 +287,432 @@ uint16_t SPI_Read(SPI_TypeDef* SPI)
     return SPI->DR;                         // Read and return received data
 }
 
+/************************************* CRC reset **********************************************
+ * @brief  Clears the TX/RX CRC registers before a new block (CRCEN toggled with SPI disabled).
+ *
+ * @param  SPI: Pointer to SPI peripheral
+ */
+static void SPI_CRC_Reset(SPI_TypeDef* SPI)
+{
+    uint32_t enabled = SPI->CR1 & SPI_CR1_SPE;
+
+    if (enabled)
+    {
+        while (SPI->SR & SPI_SR_BSY);       // Wait for the previous block to leave the shift register
+        SPI->CR1 &= ~SPI_CR1_SPE;
+    }
+    SPI->CR1 &= ~(SPI_CR1_CRCEN | SPI_CR1_CRCNEXT);
+    SPI->CR1 |= SPI_CR1_CRCEN;              // Re-enabling CRC resets TXCRCR/RXCRCR
+    SPI->SR &= ~SPI_SR_CRCERR;              // Clear a previous CRC error
+    SPI->CR1 |= enabled;
+}
+
+/************************************* Software CRC *******************************************
+ * @brief  CRC-8 as computed by the SPI CRC unit on MSB first 8-bit frames (initial value 0,
+ *         no final XOR). Used to build CRC trailers the hardware does not place itself, e.g.
+ *         on slave frame responses.
+ *
+ * @param  polynomial: CRC polynomial (CRCPR value, x^8 implicit)
+ * @param  data: Bytes to cover
+ * @param  length: Number of bytes
+ * @return CRC byte
+ */
+uint8_t SPI_CRC8(uint8_t polynomial, const uint8_t* data, uint16_t length)
+{
+    uint8_t crc = 0;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ polynomial) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*********************************** Block transfer *******************************************
+ * @brief  Blocking full-duplex transfer of an 8-bit data block.
+ *         When CRC is enabled, CRCNEXT is set after the last byte so the hardware sends its
+ *         CRC, and the CRC received from the other side is checked.
+ *
+ * @param  SPI: Pointer to SPI peripheral (enabled)
+ * @param  txData: Data to transmit (NULL: 0xFF filler)
+ * @param  rxData: Reception buffer (NULL: received data discarded)
+ * @param  length: Number of bytes, CRC not included
+ * @return SPI_OK or SPI_CRC_ERROR
+ */
+uint8_t SPI_TransferBlock(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length)
+{
+    uint8_t crcEnabled = (SPI->CR1 & SPI_CR1_CRCEN) ? 1 : 0;
+
+    TRACE(SPI_TRACE_SOURCE(SPI), TRACE_START, length);
+    if (crcEnabled)
+    {
+        SPI_CRC_Reset(SPI);
+    }
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        while (!(SPI->SR & SPI_SR_TXE));    // Wait until transmit buffer is empty
+        SPI->DR = txData ? txData[i] : 0xFF;
+
+        if (crcEnabled && i == (length - 1))
+        {
+            SPI->CR1 |= SPI_CR1_CRCNEXT;    // CRC follows the last data byte
+        }
+
+        while (!(SPI->SR & SPI_SR_RXNE));   // Wait until the byte has been received
+        uint8_t data = SPI->DR;
+        if (rxData)
+        {
+            rxData[i] = data;
+        }
+    }
+
+    if (crcEnabled)
+    {
+        while (!(SPI->SR & SPI_SR_RXNE));   // Received CRC
+        (void)SPI->DR;
+
+        if (SPI->SR & SPI_SR_CRCERR)
+        {
+            SPI->SR &= ~SPI_SR_CRCERR;      // Clear flag (write 0)
+            TRACE(SPI_TRACE_SOURCE(SPI), TRACE_ERROR, SPI_CRC_ERROR);
+            TRACE(SPI_TRACE_SOURCE(SPI), TRACE_DONE, length);
+            return SPI_CRC_ERROR;
+        }
+    }
+
+    TRACE(SPI_TRACE_SOURCE(SPI), TRACE_DONE, length);
+    return SPI_OK;
+}
+
+/********************************* DMA block transfer *****************************************
+ * @brief  Full-duplex transfer of an 8-bit data block through DMA; the CPU only waits for
+ *         the RX stream to complete. CRC, when enabled, is sent automatically at the end of
+ *         the TX stream and checked after the RX stream.
+ *
+ * @param  SPI: Pointer to SPI peripheral (enabled, master)
+ * @param  txData: Data to transmit (NULL: 0xFF filler)
+ * @param  rxData: Reception buffer (NULL: received data discarded)
+ * @param  length: Number of bytes, CRC not included
+ * @return SPI_OK or SPI_CRC_ERROR
+ */
+uint8_t SPI_TransferBlock_DMA(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length)
+{
+    const SPI_DMA_Typedef* dma = SPI_GetDMA(SPI);
+    uint8_t crcEnabled = (SPI->CR1 & SPI_CR1_CRCEN) ? 1 : 0;
+    uint8_t status = SPI_OK;
+
+    if (dma == 0 || length == 0)
+    {
+        return SPI_OK;
+    }
+
+    DMA_Config_Typedef rxConfig = {
+        .channel = dma->channel,
+        .direction = DMA_PERIPH_TO_MEM,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = rxData ? 1 : 0,             // Discarded data lands on a single byte
+        .priority = 3                               // RX above TX so no byte is overrun
+    };
+    DMA_Config_Typedef txConfig = {
+        .channel = dma->channel,
+        .direction = DMA_MEM_TO_PERIPH,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = txData ? 1 : 0,             // Filler repeats a single byte
+        .priority = 2
+    };
+    DMA_init(dma->rxStream, &rxConfig);
+    DMA_init(dma->txStream, &txConfig);
+
+    if (crcEnabled)
+    {
+        SPI_CRC_Reset(SPI);
+    }
+
+    TRACE(TRACE_SPI1 + (dma - spiDMA), TRACE_START, length);
+    SPI->CR2 |= SPI_CR2_RXDMAEN;                    // RX request first (RM0368 DMA sequence)
+    DMA_Start(dma->rxStream, &SPI->DR, rxData ? rxData : &dummyRx, length);
+    DMA_Start(dma->txStream, &SPI->DR, txData ? txData : &dummyTx, length);
+    SPI->CR2 |= SPI_CR2_TXDMAEN;                    // Transfer starts here
+
+    while (!(DMA_GetFlags(dma->rxStream) & DMA_FLAG_TC));   // Last byte received
+
+    if (crcEnabled)
+    {
+        while (!(SPI->SR & SPI_SR_RXNE));           // Received CRC
+        (void)SPI->DR;
+
+        if (SPI->SR & SPI_SR_CRCERR)
+        {
+            SPI->SR &= ~SPI_SR_CRCERR;
+            status = SPI_CRC_ERROR;
+        }
+    }
+
+    while (SPI->SR & SPI_SR_BSY);                   // Wait until the bus is idle
+    SPI->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    DMA_ClearFlags(dma->rxStream, DMA_FLAG_ALL);
+    DMA_ClearFlags(dma->txStream, DMA_FLAG_ALL);
+
+    if (status != SPI_OK)
+    {
+        TRACE(TRACE_SPI1 + (dma - spiDMA), TRACE_ERROR, status);
+    }
+    TRACE(TRACE_SPI1 + (dma - spiDMA), TRACE_DONE, length);
+    return status;
+}
+
+/********************************** Slave frame reception *************************************
+ * @brief  NSS framed slave reception through DMA.
+ *         NSS falling edge (EXTI) arms the RX stream and the optional TX response, NSS rising
+ *         edge closes the frame and hands the received bytes to the application callback.
+ *
+ * @note   No CPU work is done per byte; the SPI is enabled only while NSS is low so the
+ *         shift register and TX data are flushed between frames.
+ *         With CRCenable the last byte of every frame is its CRC: the CRC unit accumulates
+ *         every received byte including that trailer, so RXCRCR reads 0 on NSS rise when the
+ *         frame is intact, and the unit is reset for the next frame. The callback gets the data
+ *         without the trailer. Responses are sent as given: append SPI_CRC8 of the response
+ *         to protect it as well.
+ */
+#if SPI1_SLAVE_FRAME_ENABLE || SPI2_SLAVE_FRAME_ENABLE
+
+// hardware resources used by a slave frame receiver
+typedef struct
+{
+    const SPI_DMA_Typedef* dma;
+    GPIO_TypeDef* nssPort;
+    uint8_t nssPin;
+    uint8_t extiPort;                       // SYSCFG_EXTICR port code (0: PA, 1: PB ...)
+    IRQn_Type extiIRQ;
+}SPI_SlaveFrameHW_Typedef;
+
+static const SPI_SlaveFrameHW_Typedef slaveFrameHW[2] = {
+    { &spiDMA[0], GPIOA, 4,  0, EXTI4_IRQn },       // SPI1: NSS PA4
+    { &spiDMA[1], GPIOB, 12, 1, EXTI15_10_IRQn }    // SPI2: NSS PB12
+};
+
+static SPI_SlaveFrame_Typedef* slaveFrame[2];
+
+/**
+ * @brief  Returns the slave frame slot of the given SPI, or -1 if not supported.
+ */
+static int8_t SPI_SlaveFrameIndex(SPI_TypeDef* SPI)
+{
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (slaveFrameHW[i].dma->SPI == SPI)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief  Initializes NSS framed slave reception. SPI_init (slave mode, hardware NSS) must
+ *         be called before; the SPI is then enabled and disabled by the frame engine itself.
+ *
+ * @param  SPI: Pointer to SPI peripheral (SPI1 or SPI2)
+ * @param  frame: Pointer to frame receiver descriptor (must stay valid)
+ */
+void SPI_SlaveFrame_init(SPI_TypeDef* SPI, SPI_SlaveFrame_Typedef* frame)
+{
+    int8_t index = SPI_SlaveFrameIndex(SPI);
+    if (index < 0)
+    {
+        return;
+    }
+    const SPI_SlaveFrameHW_Typedef* hw = &slaveFrameHW[index];
+
+    slaveFrame[index] = frame;
+    frame->frameCount = 0;
+    frame->overflowCount = 0;
+    frame->crcErrorCount = 0;
+
+    // RX stream: SPI DR -> rxBuffer, one-shot, no interrupt (frame end comes from NSS)
+    DMA_Config_Typedef rxConfig = {
+        .channel = hw->dma->channel,
+        .direction = DMA_PERIPH_TO_MEM,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = 1,
+        .priority = 3
+    };
+    DMA_init(hw->dma->rxStream, &rxConfig);
+
+    // TX stream: txBuffer -> SPI DR
+    DMA_Config_Typedef txConfig = {
+        .channel = hw->dma->channel,
+        .direction = DMA_MEM_TO_PERIPH,
+        .dataSize = DMA_SIZE_8,
+        .memIncrement = 1,
+        .priority = 2
+    };
+    DMA_init(hw->dma->txStream, &txConfig);
+
+    // Route NSS pin to its EXTI line, trigger on both edges
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    SYSCFG->EXTICR[hw->nssPin >> 2] &= ~(0xFU << ((hw->nssPin & 3) * 4));
+    SYSCFG->EXTICR[hw->nssPin >> 2] |= (uint32_t)hw->extiPort << ((hw->nssPin & 3) * 4);
+    EXTI->RTSR |= (1U << hw->nssPin);
+    EXTI->FTSR |= (1U << hw->nssPin);
+    EXTI->PR = (1U << hw->nssPin);              // Discard any pending edge
+    EXTI->IMR |= (1U << hw->nssPin);
+
+    SPI->CR1 &= ~SPI_CR1_SPE;                   // Enabled per frame
+
+    __disable_irq();
+    NVIC_EnableIRQ(hw->extiIRQ);
+    __enable_irq();
+}
+
+/**
+ * @brief  Sets the response clocked out during the next frames (NULL for 0xFF filler).
+ *         The buffer must stay valid until replaced; takes effect on the next NSS falling edge.
+ */
+void SPI_SlaveFrame_SetResponse(SPI_TypeDef* SPI, const uint8_t* txBuffer, uint16_t txLength)
+{
+    int8_t index = SPI_SlaveFrameIndex(SPI);
+    if (index < 0 || slaveFrame[index] == 0)
+    {
+        return;
+    }
+
+    __disable_irq();                            // Update pointer and length atomically w.r.t. NSS edge
+    slaveFrame[index]->txBuffer = txBuffer;
+    slaveFrame[index]->txLength = txLength;
+    __enable_irq();
+}
+
+/**
+ * @brief  NSS falling edge: arm DMA for a new frame and enable the SPI.
+ */
+static void SPI_SlaveFrame_Open(const SPI_SlaveFrameHW_Typedef* hw, SPI_SlaveFrame_Typedef* frame)
+{
+    SPI_TypeDef* SPI = hw->dma->SPI;
+
+    SPI->CR2 |= SPI_CR2_RXDMAEN;                // RX DMA request enabled before the stream
+    DMA_Start(hw->dma->rxStream, &SPI->DR, frame->rxBuffer, frame->rxSize);
+
+    if (frame->txBuffer && frame->txLength)
+    {
+        DMA_Start(hw->dma->txStream, &SPI->DR, frame->txBuffer, frame->txLength);
+        SPI->CR2 |= SPI_CR2_TXDMAEN;            // First byte loaded as soon as TXE is seen
+    }
+    else
+    {
+        SPI->DR = dummyTx;                      // Filler for the whole frame
+    }
+
+    SPI->CR1 |= SPI_CR1_SPE;                    // Ready for the first clock edge
+    TRACE(TRACE_SPI1 + (hw->dma - spiDMA), TRACE_START, frame->rxSize);
+}
+
+/**
+ * @brief  NSS rising edge: stop DMA, disable the SPI and deliver the frame.
+ */
+static void SPI_SlaveFrame_Close(const SPI_SlaveFrameHW_Typedef* hw, SPI_SlaveFrame_Typedef* frame)
+{
+    SPI_TypeDef* SPI = hw->dma->SPI;
+
+    DMA_Stop(hw->dma->rxStream);                     // Last byte already moved (RXNE precedes NSS release)
+    DMA_Stop(hw->dma->txStream);
+    SPI->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+
+    uint16_t length = frame->rxSize - DMA_Remaining(hw->dma->rxStream);
+    uint8_t truncated = (length == frame->rxSize && (SPI->SR & (SPI_SR_RXNE | SPI_SR_OVR)));
+    if (truncated)
+    {
+        frame->overflowCount++;                 // Buffer filled and more bytes arrived: truncated
+        TRACE(TRACE_SPI1 + (hw->dma - spiDMA), TRACE_ERROR, SPI_SR_OVR);
+    }
+
+    SPI->CR1 &= ~SPI_CR1_SPE;                   // Flush TX data not clocked out by the master
+    uint8_t data = SPI->DR;                     // Clear RXNE/OVR left by a truncated frame
+    data = SPI->SR;
+    (void)data;
+
+    if (SPI->CR1 & SPI_CR1_CRCEN)
+    {
+        if (length && !truncated)
+        {
+            length--;                           // Trailer: CRC of the bytes before it
+            if (SPI->RXCRCR != 0)               // Residue over data and trailer
+            {
+                frame->crcErrorCount++;
+                TRACE(TRACE_SPI1 + (hw->dma - spiDMA), TRACE_ERROR, SPI_SR_CRCERR);
+            }
+        }
+        SPI_CRC_Reset(SPI);                     // SPE is off: clears RXCRCR for the next frame
+    }
+
+    frame->frameCount++;
+    TRACE(TRACE_SPI1 + (hw->dma - spiDMA), TRACE_DONE, length);
+    if (frame->frameReceived)
+    {
+        frame->frameReceived(frame->rxBuffer, length);
+    }
+    if (frame->frameEvent)
+    {
+        Event_Post(frame->frameEvent, length);
+    }
+}
+
+/**
+ * @brief  Common NSS edge handler.
+ */
+static void SPI_SlaveFrame_IRQHandler(uint8_t index)
+{
+    const SPI_SlaveFrameHW_Typedef* hw = &slaveFrameHW[index];
+    SPI_SlaveFrame_Typedef* frame = slaveFrame[index];
+
+    if (!(EXTI->PR & (1U << hw->nssPin)))
+    {
+        return;
+    }
+    EXTI->PR = (1U << hw->nssPin);              // Clear pending edge
+
+    if (frame == 0)
+    {
+        return;
+    }
+
+    if (hw->nssPort->IDR & (1U << hw->nssPin))
+    {
+        if (hw->dma->SPI->CR1 & SPI_CR1_SPE)
+        {
+            SPI_SlaveFrame_Close(hw, frame);    // NSS high: master deselected us
+        }
+    }
+    else
+    {
+        SPI_SlaveFrame_Open(hw, frame);         // NSS low: frame starts
+    }
+}
+#endif
+
+#if SPI1_SLAVE_FRAME_ENABLE
+void EXTI4_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    SPI_SlaveFrame_IRQHandler(0);
+    PROFILE_ISR_EXIT(PROFILE_SPI1_NSS);
+}
+#endif
+
+#if SPI2_SLAVE_FRAME_ENABLE
+void EXTI15_10_IRQHandler(void)
+{
+    PROFILE_ISR_ENTER();
+    SPI_SlaveFrame_IRQHandler(1);
+    PROFILE_ISR_EXIT(PROFILE_SPI2_NSS);
+}
+#endif
+
 /****************************************** ISR ***********************************************
  * @brief  SPI interrupt handlers for buffered transmit/receive.
  *         Handles TXE (transmit buffer empty), RXNE (receive buffer not empty), and OVR (overrun error).
@@ -153,8 +720,10 @@ uint16_t SPI_Read(SPI_TypeDef* SPI)
  * @note   Uses ring buffers for efficient interrupt-driven communication.
  */
 #if SPI1_INTERRUPT_ENABLE
-void SPI_IRQHandler(void) 
+void SPI1_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     // Handle transmit buffer empty interrupt
     if (SPI1->SR & SPI_SR_TXE)
     {
@@ -186,16 +755,21 @@ void SPI_IRQHandler(void)
     // Handle overrun error interrupt
     if (SPI1->SR & SPI_SR_OVR)
     {
+        TRACE(TRACE_SPI1, TRACE_ERROR, SPI_SR_OVR);
         uint8_t data = SPI1->DR;                        // Clear OVR by reading DR and SR
         data = SPI1->SR;
         (void)data;
     }
+
+    PROFILE_ISR_EXIT(PROFILE_SPI1);
 }
 #endif
 
 #if SPI2_INTERRUPT_ENABLE
-void SPI_IRQHandler(void) 
+void SPI2_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     if (SPI2->SR & SPI_SR_TXE)
     {
         if (!(ringBuffer_isEmpty(&SPI2_Buff)))
@@ -224,16 +798,21 @@ void SPI_IRQHandler(void)
 
     if (SPI2->SR & SPI_SR_OVR)
     {
+        TRACE(TRACE_SPI2, TRACE_ERROR, SPI_SR_OVR);
         uint8_t data = SPI2->DR;
         data = SPI2->SR;
         (void)data;
     }
+
+    PROFILE_ISR_EXIT(PROFILE_SPI2);
 }
 #endif
 
 #if SPI3_INTERRUPT_ENABLE
-void SPI_IRQHandler(void) 
+void SPI3_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     if (SPI3->SR & SPI_SR_TXE)
     {
         if (!(ringBuffer_isEmpty(&SPI3_Buff)))
@@ -262,9 +841,12 @@ void SPI_IRQHandler(void)
 
     if (SPI3->SR & SPI_SR_OVR)
     {
+        TRACE(TRACE_SPI3, TRACE_ERROR, SPI_SR_OVR);
         uint8_t data = SPI3->DR;
         data = SPI3->SR;
         (void)data;
     }
+
+    PROFILE_ISR_EXIT(PROFILE_SPI3);
 }
 #endif
\ No newline at end of file
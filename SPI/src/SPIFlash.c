@@ -0,0 +1,306 @@
+#include "SPIFlash.h"
+
+// W25Qxx command set
+#define CMD_WRITE_ENABLE    0x06
+#define CMD_READ_STATUS1    0x05
+#define CMD_PAGE_PROGRAM    0x02
+#define CMD_FAST_READ       0x0B
+#define CMD_ERASE_4K        0x20
+#define CMD_ERASE_32K       0x52
+#define CMD_ERASE_64K       0xD8
+#define CMD_JEDEC_ID        0x9F
+
+#define STATUS_WIP          0x01        // Write in progress
+#define DMA_MAX_CHUNK       0xFFFF      // NDTR is 16-bit
+
+/*********************************** Chip select helpers **************************************/
+static void SPIFlash_Select(SPIFlash_Typedef* flash)
+{
+    flash->csPort->BSRR = 1U << (flash->csPin + 16);    // CS low
+}
+
+static void SPIFlash_Deselect(SPIFlash_Typedef* flash)
+{
+    while (flash->SPI->SR & SPI_SR_BSY);                // Last byte fully clocked out
+    flash->csPort->BSRR = 1U << flash->csPin;           // CS high
+}
+
+/**
+ * @brief  Sends a command byte followed by an optional 24-bit address and dummy byte.
+ *         Chip select must already be low.
+ */
+static void SPIFlash_Header(SPIFlash_Typedef* flash, uint8_t command, uint32_t address, uint8_t addressBytes, uint8_t dummyBytes)
+{
+    uint8_t header[5];
+    uint8_t length = 0;
+
+    header[length++] = command;
+    if (addressBytes)
+    {
+        header[length++] = (address >> 16) & 0xFF;
+        header[length++] = (address >> 8) & 0xFF;
+        header[length++] = address & 0xFF;
+    }
+    while (dummyBytes--)
+    {
+        header[length++] = 0xFF;
+    }
+
+    SPI_TransferBlock(flash->SPI, header, 0, length);
+}
+
+/**
+ * @brief  Moves a data block, through DMA when long enough to pay for the stream setup.
+ */
+static void SPIFlash_Data(SPIFlash_Typedef* flash, const uint8_t* txData, uint8_t* rxData, uint32_t length)
+{
+    while (length)
+    {
+        uint16_t chunk = (length > DMA_MAX_CHUNK) ? DMA_MAX_CHUNK : length;
+
+        if (chunk >= SPIFLASH_DMA_THRESHOLD)
+        {
+            SPI_TransferBlock_DMA(flash->SPI, txData, rxData, chunk);
+        }
+        else
+        {
+            SPI_TransferBlock(flash->SPI, txData, rxData, chunk);
+        }
+
+        if (txData)
+        {
+            txData += chunk;
+        }
+        if (rxData)
+        {
+            rxData += chunk;
+        }
+        length -= chunk;
+    }
+}
+
+/**
+ * @brief  Sends a single byte command (no address, no data).
+ */
+static void SPIFlash_Command(SPIFlash_Typedef* flash, uint8_t command)
+{
+    SPIFlash_Select(flash);
+    SPIFlash_Header(flash, command, 0, 0, 0);
+    SPIFlash_Deselect(flash);
+}
+
+/**
+ * @brief  Reads status register 1.
+ */
+static uint8_t SPIFlash_ReadStatus(SPIFlash_Typedef* flash)
+{
+    uint8_t status;
+
+    SPIFlash_Select(flash);
+    SPIFlash_Header(flash, CMD_READ_STATUS1, 0, 0, 0);
+    SPI_TransferBlock(flash->SPI, 0, &status, 1);
+    SPIFlash_Deselect(flash);
+
+    return status;
+}
+
+/************************************ Busy handling *******************************************
+ * @brief  Program and erase commands return as soon as they are issued; the WIP bit is only
+ *         polled before the next command, so the chip programs while the caller works.
+ *
+ * @param  flash: Pointer to flash descriptor
+ * @return SPIFlash_IsBusy: 1 while a program/erase is still running
+ */
+uint8_t SPIFlash_IsBusy(SPIFlash_Typedef* flash)
+{
+    if (flash->busy)
+    {
+        if (SPIFlash_ReadStatus(flash) & STATUS_WIP)
+        {
+            flash->stats.busyPolls++;
+            return 1;
+        }
+        flash->busy = 0;
+    }
+    return 0;
+}
+
+void SPIFlash_WaitReady(SPIFlash_Typedef* flash)
+{
+    while (SPIFlash_IsBusy(flash));
+}
+
+/*************************************** Setup flash ******************************************
+ * @brief  Configures chip select, reads the JEDEC ID and derives the capacity.
+ *
+ * @param  flash: Pointer to flash descriptor (SPI, csPort and csPin filled in)
+ * @return SPIFLASH_OK or SPIFLASH_NOT_FOUND
+ * @note   The SPI must be initialized as master with software NSS before this call.
+ */
+uint8_t SPIFlash_init(SPIFlash_Typedef* flash)
+{
+    uint8_t id[3];
+
+    // Chip select as push-pull output, idle high
+    RCC->AHB1ENR |= 1U << (((uint32_t)flash->csPort - GPIOA_BASE) / 0x400U);
+    flash->csPort->BSRR = 1U << flash->csPin;
+    flash->csPort->MODER &= ~(3U << (flash->csPin * 2));
+    flash->csPort->MODER |= (1U << (flash->csPin * 2));
+    flash->csPort->OSPEEDR |= (3U << (flash->csPin * 2));
+
+    SPI_Enable(flash->SPI);
+
+    flash->busy = 0;
+    flash->stats = (SPIFlash_Stats_Typedef){0};
+
+    SPIFlash_Select(flash);
+    SPIFlash_Header(flash, CMD_JEDEC_ID, 0, 0, 0);
+    SPI_TransferBlock(flash->SPI, 0, id, 3);
+    SPIFlash_Deselect(flash);
+
+    flash->jedecID = ((uint32_t)id[0] << 16) | ((uint32_t)id[1] << 8) | id[2];
+    if (id[0] == 0x00 || id[0] == 0xFF || id[2] < 16 || id[2] > 24)
+    {
+        flash->capacity = 0;
+        return SPIFLASH_NOT_FOUND;                      // No answer or beyond 3-byte addressing
+    }
+
+    flash->capacity = 1UL << id[2];                     // Capacity code is log2(bytes)
+    return SPIFLASH_OK;
+}
+
+/*************************************** Read data ********************************************
+ * @brief  Fast read (0x0B) of an arbitrary range; large reads stream through DMA.
+ *
+ * @param  flash: Pointer to flash descriptor
+ * @param  address: Start address
+ * @param  data: Destination buffer
+ * @param  length: Number of bytes
+ * @return SPIFLASH_OK or SPIFLASH_OUT_OF_RANGE
+ */
+uint8_t SPIFlash_Read(SPIFlash_Typedef* flash, uint32_t address, uint8_t* data, uint32_t length)
+{
+    if (length > flash->capacity || address > flash->capacity - length)
+    {
+        return SPIFLASH_OUT_OF_RANGE;                   // address + length could wrap
+    }
+
+    SPIFlash_WaitReady(flash);                          // Reads are rejected while programming
+
+    SPIFlash_Select(flash);
+    SPIFlash_Header(flash, CMD_FAST_READ, address, 3, 1);
+    SPIFlash_Data(flash, 0, data, length);
+    SPIFlash_Deselect(flash);
+
+    flash->stats.bytesRead += length;
+    return SPIFLASH_OK;
+}
+
+/*************************************** Write data *******************************************
+ * @brief  Programs an arbitrary range (must be erased), split on page boundaries.
+ *         Each page program is issued as soon as the previous one completes, and the call
+ *         returns without waiting for the last page so the caller overlaps its own work.
+ *
+ * @param  flash: Pointer to flash descriptor
+ * @param  address: Start address
+ * @param  data: Source buffer
+ * @param  length: Number of bytes
+ * @return SPIFLASH_OK or SPIFLASH_OUT_OF_RANGE
+ */
+uint8_t SPIFlash_Write(SPIFlash_Typedef* flash, uint32_t address, const uint8_t* data, uint32_t length)
+{
+    if (length > flash->capacity || address > flash->capacity - length)
+    {
+        return SPIFLASH_OUT_OF_RANGE;                   // address + length could wrap
+    }
+
+    while (length)
+    {
+        uint32_t chunk = SPIFLASH_PAGE_SIZE - (address % SPIFLASH_PAGE_SIZE);  // Up to page end
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+
+        SPIFlash_WaitReady(flash);                      // Previous page still programming
+        SPIFlash_Command(flash, CMD_WRITE_ENABLE);
+
+        SPIFlash_Select(flash);
+        SPIFlash_Header(flash, CMD_PAGE_PROGRAM, address, 3, 0);
+        SPIFlash_Data(flash, data, 0, chunk);
+        SPIFlash_Deselect(flash);                       // Programming starts on CS high
+        flash->busy = 1;
+
+        flash->stats.pagePrograms++;
+        flash->stats.bytesWritten += chunk;
+
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return SPIFLASH_OK;
+}
+
+/*************************************** Erase range ******************************************
+ * @brief  Erases every 4K sector touched by the range, using 64K and 32K block erases
+ *         wherever alignment allows (a block erase takes far less than 8 or 16 sector erases).
+ *
+ * @param  flash: Pointer to flash descriptor
+ * @param  address: Start address (rounded down to 4K)
+ * @param  length: Number of bytes (end rounded up to 4K, 0: nothing erased)
+ * @return SPIFLASH_OK or SPIFLASH_OUT_OF_RANGE
+ */
+uint8_t SPIFlash_Erase(SPIFlash_Typedef* flash, uint32_t address, uint32_t length)
+{
+    if (length > flash->capacity || address > flash->capacity - length)
+    {
+        return SPIFLASH_OUT_OF_RANGE;                   // address + length could wrap
+    }
+    if (length == 0)
+    {
+        return SPIFLASH_OK;                             // Rounding would still erase a sector
+    }
+
+    uint32_t end = (address + length + SPIFLASH_SECTOR_4K - 1) & ~(SPIFLASH_SECTOR_4K - 1);
+    address &= ~(SPIFLASH_SECTOR_4K - 1);
+
+    while (address < end)
+    {
+        uint32_t remaining = end - address;
+        uint32_t size;
+        uint8_t command;
+
+        if (!(address % SPIFLASH_BLOCK_64K) && remaining >= SPIFLASH_BLOCK_64K)
+        {
+            command = CMD_ERASE_64K;
+            size = SPIFLASH_BLOCK_64K;
+            flash->stats.erase64K++;
+        }
+        else if (!(address % SPIFLASH_BLOCK_32K) && remaining >= SPIFLASH_BLOCK_32K)
+        {
+            command = CMD_ERASE_32K;
+            size = SPIFLASH_BLOCK_32K;
+            flash->stats.erase32K++;
+        }
+        else
+        {
+            command = CMD_ERASE_4K;
+            size = SPIFLASH_SECTOR_4K;
+            flash->stats.erase4K++;
+        }
+
+        SPIFlash_WaitReady(flash);
+        SPIFlash_Command(flash, CMD_WRITE_ENABLE);
+
+        SPIFlash_Select(flash);
+        SPIFlash_Header(flash, command, address, 3, 0);
+        SPIFlash_Deselect(flash);                       // Erase starts on CS high
+        flash->busy = 1;
+
+        flash->stats.bytesErased += size;
+        address += size;
+    }
+
+    return SPIFLASH_OK;
+}
@@ -1,5 +1,80 @@
 #include "UART.h"
 
+// baud rate of each initialized UART (0: unused), kept to recompute BRR on clock changes
+static USART_TypeDef* const uartInstance[3] = {USART1, USART2, USART6};
+static uint32_t uartBaud[3];
+static uint32_t uartTxInterrupt[3];     // TXEIE held during a clock change
+static Event_Handler uartRxEvent[3];    // Posted with every received byte (interrupt mode)
+
+/**
+ * @brief  Returns the table index of the given UART instance.
+ */
+static uint8_t UART_Index(USART_TypeDef* UART)
+{
+    if ((void*)UART == (void*)UART1)
+        return 0;
+    else if ((void*)UART == (void*)UART2)
+        return 1;
+    return 2;
+}
+
+#if TRACE_ENABLE
+/**
+ * @brief  Reads the received byte and records it; a parity, framing, noise or overrun flag
+ *         (cleared by the DR read) turns the record into an error with the flags in the high byte.
+ */
+static uint8_t UART_TraceRx(USART_TypeDef* UART, uint8_t source)
+{
+    uint8_t errors = UART->SR & (USART_SR_PE | USART_SR_FE | USART_SR_NE | USART_SR_ORE);
+    uint8_t data = UART->DR;
+
+    Trace_Record(source, errors ? TRACE_ERROR : TRACE_RX, ((uint16_t)errors << 8) | data);
+    return data;
+}
+#define UART_READ_DR(UART, source)  UART_TraceRx(UART, source)
+#else
+#define UART_READ_DR(UART, source)  ((UART)->DR)
+#endif
+
+/**
+ * @brief  BRR value for baudRate from the running APB clock of this UART (rounded to nearest).
+ */
+static uint32_t UART_Divider(USART_TypeDef* UART, uint32_t baudRate)
+{
+    return (Clock_GetBusClock(UART) + (baudRate / 2)) / baudRate;
+}
+
+/**
+ * @brief  Reclock notification: holds interrupt driven transmission and lets the last byte
+ *         leave at the old rate, then reprograms BRR so the baud rate does not change.
+ */
+static void UART_Reclock(uint8_t event)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        USART_TypeDef* UART = uartInstance[i];
+
+        if (!uartBaud[i])
+        {
+            continue;
+        }
+        if (event == CLOCK_PRE_CHANGE)
+        {
+            uartTxInterrupt[i] = UART->CR1 & USART_CR1_TXEIE;
+            UART->CR1 &= ~USART_CR1_TXEIE;                  // Ring buffer keeps the pending bytes
+            if (UART->CR1 & USART_CR1_TE)
+            {
+                while (!(UART->SR & USART_SR_TC));          // Wait until transmission is complete
+            }
+        }
+        else
+        {
+            UART->BRR = UART_Divider(UART, uartBaud[i]);
+            UART->CR1 |= uartTxInterrupt[i];                // Resume at the same baud rate
+        }
+    }
+}
+
 /*************************************** Setup UART *******************************************
  * @brief  Initializes the UART peripheral according to the specified parameters in uartConfig.
  *
@@ -61,8 +136,10 @@ void UART_init(USART_TypeDef* UART, UART_Typedef* uartConfig)
     // Set stop bit configuration (default: 1 stop bit)
     UART->CR2 |= 0x00003000;
 
-    // Configure baud rate
-    UART->BRR = (uartConfig->peripheralClock/uartConfig->baudRate)+1;
+    // Configure baud rate from the running APB clock, recomputed on clock changes
+    UART->BRR = UART_Divider(UART, uartConfig->baudRate);
+    uartBaud[UART_Index(UART)] = uartConfig->baudRate;
+    Clock_Register(UART_Reclock);
 
     // Configure UART mode: TX, RX, or both
     switch (uartConfig->mode)
@@ -115,6 +192,7 @@ void UART_EnableInterrupts(USART_TypeDef* UART)
 // Enable only transmit interrupt
 void UART_EnableInterrupts_Tx(USART_TypeDef* UART)
 {
+    TRACE(TRACE_USART1 + UART_Index(UART), TRACE_START, 0);
     UART->CR1 |= USART_CR1_TXEIE;                       // Enable TXE interrupt
 }
 
@@ -124,6 +202,18 @@ void UART_EnableInterrupts_Rx(USART_TypeDef* UART)
     UART->CR1 |= USART_CR1_RXNEIE;                      // Enable RXNE interrupt
 }
 
+/**
+ * @brief  Posts handler to the event loop with every byte the RX interrupt receives, so the
+ *         application handles input from Event_Run instead of polling the ring buffer.
+ *
+ * @param  UART: Pointer to USART peripheral (interrupt enabled in UART.h)
+ * @param  handler: Event handler, called with the received byte (NULL: no events)
+ */
+void UART_SetRxEvent(USART_TypeDef* UART, Event_Handler handler)
+{
+    uartRxEvent[UART_Index(UART)] = handler;
+}
+
 /************************************* ISR for UART Tx & Rx *************************************
  * @brief  UART interrupt handlers for buffered transmit/receive.
  *         Handles TXE (transmit buffer empty) and RXNE (receive buffer not empty).
@@ -133,6 +223,8 @@ void UART_EnableInterrupts_Rx(USART_TypeDef* UART)
 #if UART1_INTERRUPT_ENABLE
 void USART1_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     // Handle transmit buffer empty interrupt
     if (USART1->SR & USART_SR_TXE)
     {
@@ -144,24 +236,33 @@ void USART1_IRQHandler(void)
         else
         {
             USART1->CR1 &= ~USART_CR1_TXEIE;                // Disable TXE interrupt if buffer is empty
+            TRACE(TRACE_USART1, TRACE_DONE, 0);             // TX ring drained
         }
     }
 
     // Handle receive buffer not empty interrupt
     if (USART1->SR & USART_SR_RXNE)
     {
-        uint8_t Rx_data = USART1->DR;                       // Read received data
+        uint8_t Rx_data = UART_READ_DR(USART1, TRACE_USART1); // Read received data
+        if (uartRxEvent[0])
+        {
+            Event_Post(uartRxEvent[0], Rx_data);
+        }
         if (!(ringBuffer_isFull(&UART1_Buff)))
         {
             ringBuffer_Write(&UART1_Buff, Rx_data);         // Store data in buffer
         }
     }
+
+    PROFILE_ISR_EXIT(PROFILE_USART1);
 }
 #endif
 
 #if UART2_INTERRUPT_ENABLE
 void USART2_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     if (USART2->SR & USART_SR_TXE)
     {
         if (!(ringBuffer_isEmpty(&UART2_Buff)))
@@ -172,23 +273,32 @@ void USART2_IRQHandler(void)
         else
         {
             USART2->CR1 &= ~USART_CR1_TXEIE;
+            TRACE(TRACE_USART2, TRACE_DONE, 0);             // TX ring drained
         }
     }
 
     if (USART2->SR & USART_SR_RXNE)
     {
-        uint8_t Rx_data = USART2->DR;
+        uint8_t Rx_data = UART_READ_DR(USART2, TRACE_USART2);
+        if (uartRxEvent[1])
+        {
+            Event_Post(uartRxEvent[1], Rx_data);
+        }
         if (!(ringBuffer_isFull(&UART2_Buff)))
         {
             ringBuffer_Write(&UART2_Buff, Rx_data);
         }
     }
+
+    PROFILE_ISR_EXIT(PROFILE_USART2);
 }
 #endif
 
 #if UART6_INTERRUPT_ENABLE
 void USART6_IRQHandler(void)
 {
+    PROFILE_ISR_ENTER();
+
     if (USART6->SR & USART_SR_TXE)
     {
         if (!(ringBuffer_isEmpty(&UART6_Buff)))
@@ -199,16 +309,23 @@ void USART6_IRQHandler(void)
         else
         {
             USART6->CR1 &= ~USART_CR1_TXEIE;
+            TRACE(TRACE_USART6, TRACE_DONE, 0);             // TX ring drained
         }
     }
 
     if (USART6->SR & USART_SR_RXNE)
     {
-        uint8_t Rx_data = USART6->DR;
+        uint8_t Rx_data = UART_READ_DR(USART6, TRACE_USART6);
+        if (uartRxEvent[2])
+        {
+            Event_Post(uartRxEvent[2], Rx_data);
+        }
         if (!(ringBuffer_isFull(&UART6_Buff)))
         {
             ringBuffer_Write(&UART6_Buff, Rx_data);
         }
     }
+
+    PROFILE_ISR_EXIT(PROFILE_USART6);
 }
 #endif
\ No newline at end of file
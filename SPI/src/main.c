@@ -1,7 +1,5 @@
 #include "main.h"
 
-#define SysCoreClk 42000000     // System core clock frequency in Hz
-
 // SPI1 configuration: Master, 8-bit, MSB first, Mode 2 (CPOL=1, CPHA=0)
 SPIconfig_Typedef SPI1_config = {
     .baudRatePrescaler = PRE_256,       // Baud rate prescaler: divide clock by 256
@@ -23,10 +21,52 @@ SPIconfig_Typedef SPI2_config = {
     .softwareNSS = 0                    // Hardware NSS management
 };
 
+uint8_t SPI2_RxFrame[SPI_BUFFER_SIZE];  // Slave frame buffer filled by DMA
+
+/**
+ * @brief  Event posted by the NSS rising edge interrupt once the master deselects SPI2.
+ */
+static void SPI2_FrameReceived(uint32_t length)
+{
+    /*
+    for (uint16_t i = 0; i < length; i++)
+    {
+        UART_Write(UART1, SPI2_RxFrame[i]);    // Optional: Print received frame via UART1
+    }
+    */
+}
+
+// SPI2 slave frame receiver: DMA armed on NSS falling edge, frame delivered on rising edge
+SPI_SlaveFrame_Typedef SPI2_Frame = {
+    .rxBuffer = SPI2_RxFrame,
+    .rxSize = sizeof(SPI2_RxFrame),
+    .txBuffer = 0,                      // No response, slave clocks out 0xFF
+    .frameEvent = SPI2_FrameReceived    // Handled from the event loop
+};
+
+/**
+ * @brief  Timer callback: sends one frame from SPI1 (master) to SPI2 (slave) every second.
+ */
+static void SPI1_SendFrame(uint32_t arg)
+{
+    SPI_Enable(SPI_1);                  // Enable SPI1 (master), NSS goes low and opens the slave frame
+
+    char* str = "Hello World\n\r";      // String to transmit over SPI
+
+    while (*str)
+    {
+        SPI_Write(SPI_1, *str++);       // Master transmits data byte, slave receives it through DMA
+        SPI_Read(SPI_1);                // Read to clear overrun flag in master
+    }
+
+    SPI_Disable(SPI_1);                 // NSS goes high and closes the slave frame
+}
+
+Event_Timer_Typedef SPI1_FrameTimer = { .callback = SPI1_SendFrame };
+
 /*
 UART_Typedef UART1_config = {
     .baudRate = 9600,
-    .peripheralClock = SysCoreClk,
     .mode = UART_TX,
     .NoStopBit = 1
 };
@@ -41,36 +81,9 @@ int main(void)
 
     SPI_init(SPI_1, &SPI1_config);          // Initialize SPI1 as master
     SPI_init(SPI_2, &SPI2_config);          // Initialize SPI2 as slave
+    SPI_SlaveFrame_init(SPI_2, &SPI2_Frame);// SPI2 enabled per frame by NSS edges
 
-    uint8_t data;                           // Variable to hold received data
-
-    while (1)
-    {
-        SPI_Enable(SPI_1);                  // Enable SPI1 (master)
-        SPI_Enable(SPI_2);                  // Enable SPI2 (slave)
-
-        char* str = "Hello World\n\r";      // String to transmit over SPI
+    Event_TimerStart(&SPI1_FrameTimer, 0, 1000000);    // First frame now, then every second
 
-        while (*str)
-        {
-            SPI_Write(SPI_1, *str++);       // Master transmits data byte
-            SPI_Read(SPI_1);                // Read to clear overrun flag in master
-
-            // Check if NSS (slave select) pin goes high (master deselects slave)
-            if (GPIOB->IDR & GPIO_IDR_ID12)
-            {
-                break;
-            }
-
-            SPI_Write(SPI_2, 0xFF);         // Slave sends dummy byte (required for full-duplex SPI)
-            data = SPI_Read(SPI_2);         // Slave receives data from master
-
-            //UART_Write(UART1, data);        // Optional: Print received data via UART1
-        }
-
-        SPI_Disable(SPI_1);                 // Disable SPI1 after transmission
-        SPI_Disable(SPI_2);                 // Disable SPI2 after transmission
-
-        Delay_ms(1000);                     // Wait 1 second before next transmission
-    }
-}
\ No newline at end of file
+    Event_Run();                            // Sleeps until a timer expires or an interrupt posts
+}
@@ -1,45 +1,35 @@
 #include "main.h"
 
-#define PLLM            (25U)          // PLLM division factor for PLL input clock
-#define PLLN            (252U << 6)    // PLLN multiplication factor for VCO
-#define PLLP            (1U << 17)     // PLLP division factor for main system clock
-#define PSC_VALUE       41             // Timer prescaler value for TIM11
-#define ARR_VALUE       0xFFFF         // Timer auto-reload value for TIM11
-
-/************************************* System Clock Configuration **************************************
- * @brief  Configures the system clock to 42MHz using HSE and PLL.
- *         Sets up PLL parameters, flash latency, and bus prescalers for STM32F4.
- */
-static void SysClockConfig_42Mhz()
-{
-    RCC->CR |= RCC_CR_HSEON;                        // Enable High Speed External (HSE) oscillator
-    while (!(RCC->CR & RCC_CR_HSERDY));             // Wait for HSE to be ready
-    
-    RCC->PLLCFGR |= RCC_PLLCFGR_PLLSRC_HSE;         // Set HSE as PLL clock source
-
-    RCC->APB1ENR |= RCC_APB1ENR_PWREN;              // Enable Power interface clock
-    PWR->CR |= PWR_CR_VOS_1;                        // Set voltage scaling (Scale 2 mode)
+uint32_t SystemCoreClock = CLOCK_HSI;              // Reset clock, updated by SystemCoreClockUpdate
 
-    FLASH->ACR |= FLASH_ACR_LATENCY_2WS             // Set Flash latency to 2 wait states
-                  | FLASH_ACR_DCEN                  // Enable data cache 
-                  | FLASH_ACR_PRFTEN                // Enable prefetch
-                  | FLASH_ACR_ICEN;                 // Enable instruction cache
+// AHB prescaler (HPRE) code 1xxx to shift: /2, /4, /8, /16, /64, /128, /256, /512
+static const uint8_t ahbShift[8] = {1, 2, 3, 4, 6, 7, 8, 9};
 
-    RCC->PLLCFGR |= PLLM | PLLN | PLLP;             // Set PLLM, PLLN, PLLP for desired frequency
+/************************************* I2S Clock Configuration *****************************************
+ * @brief  Configures and starts PLLI2S, the I2S kernel clock (I2SxCLK = 1MHz * plli2sn / plli2sr).
+ *         Shares the PLLM input divider with the main PLL, so call it after Clock_init.
+ *
+ * @param  plli2sn: VCO multiplication factor (192..432)
+ * @param  plli2sr: Output division factor (2..7)
+ * @note   plli2sn = 258, plli2sr = 3 gives 86MHz: 47.991kHz for 16 and 32-bit frames at 48kHz.
+ */
+void SysClockConfig_PLLI2S(uint16_t plli2sn, uint8_t plli2sr)
+{
+    RCC->CR |= RCC_CR_HSEON;                        // Input clock (Clock_init stops HSE at 16MHz)
+    while (!(RCC->CR & RCC_CR_HSERDY));
 
-    RCC->CFGR |= RCC_CFGR_HPRE_DIV1                 // Set AHB prescaler to 1
-                 | RCC_CFGR_PPRE1_DIV1              // Set APB1 prescaler to 1
-                 | RCC_CFGR_PPRE2_DIV1;             // Set APB2 prescaler to 1
+    RCC->CR &= ~RCC_CR_PLLI2SON;                    // PLLI2S must be off while reconfigured
+    while (RCC->CR & RCC_CR_PLLI2SRDY);
 
-    RCC->CR |= RCC_CR_PLLON;                        // Enable PLL
-    while (!(RCC->CR & RCC_CR_PLLRDY));             // Wait for PLL to be ready
+    RCC->PLLI2SCFGR = ((uint32_t)plli2sn << RCC_PLLI2SCFGR_PLLI2SN_Pos)
+                    | ((uint32_t)plli2sr << RCC_PLLI2SCFGR_PLLI2SR_Pos);
 
-    RCC->CFGR |= RCC_CFGR_SW_PLL;                   // Select PLL as system clock source
-    while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_1);   // Wait until PLL is used as system clock
+    RCC->CR |= RCC_CR_PLLI2SON;                     // Enable PLLI2S
+    while (!(RCC->CR & RCC_CR_PLLI2SRDY));          // Wait for PLLI2S to lock
 }
 
 /****************************************** GPIO Configuration *****************************************
- * @brief  Configures GPIOA and GPIOB for SPI1, SPI2, and UART1 alternate functions.
+ * @brief  Configures GPIOA and GPIOB for SPI1, SPI2, SPI3 and UART1 alternate functions.
  *         Sets mode, speed, pull-up, and alternate function registers for each pin.
  */
 static void gpioConfig()
@@ -67,6 +57,19 @@ static void gpioConfig()
     // Set AF5 (SPI2) for the pins
     GPIOB->AFR[1] |= (5 << GPIO_AFRH_AFSEL12_Pos) | (5 << GPIO_AFRH_AFSEL13_Pos) | (5 << GPIO_AFRH_AFSEL14_Pos) | (5 << GPIO_AFRH_AFSEL15_Pos);
 
+    // --- SPI3 (GPIOB) Pin Configuration, SD card ---
+    // Set PB3 (SCK), PB4 (MISO), PB5 (MOSI) to Alternate Function mode (PB3/PB4 leave JTAG, SWD unaffected)
+    GPIOB->MODER &= ~(GPIO_MODER_MODE3 | GPIO_MODER_MODE4 | GPIO_MODER_MODE5);
+    GPIOB->MODER |= GPIO_MODER_MODE3_1 | GPIO_MODER_MODE4_1 | GPIO_MODER_MODE5_1;
+    // Set pull-up for MISO (card drives it open-drain during initialization)
+    GPIOB->PUPDR &= ~(GPIO_PUPDR_PUPD3 | GPIO_PUPDR_PUPD4 | GPIO_PUPDR_PUPD5);
+    GPIOB->PUPDR |= GPIO_PUPDR_PUPD4_0;
+    // Set high speed for SPI pins
+    GPIOB->OSPEEDR |= GPIO_OSPEEDER_OSPEEDR3_1 | GPIO_OSPEEDER_OSPEEDR4_1 | GPIO_OSPEEDER_OSPEEDR5_1;
+    // Set AF6 (SPI3) for the pins
+    GPIOB->AFR[0] &= ~(GPIO_AFRL_AFSEL3 | GPIO_AFRL_AFSEL4 | GPIO_AFRL_AFSEL5);
+    GPIOB->AFR[0] |= (6 << GPIO_AFRL_AFSEL3_Pos) | (6 << GPIO_AFRL_AFSEL4_Pos) | (6 << GPIO_AFRL_AFSEL5_Pos);
+
     // --- UART1 (GPIOA) Pin Configuration ---
     // Set PA9 (TX), PA10 (RX) to Alternate Function mode and high speed
     GPIOA->MODER |= (0xA << 18);            // Alternate function for PA9, PA10
@@ -74,42 +77,35 @@ static void gpioConfig()
     GPIOA->AFR[1] |= (0x77 << 4);           // AF7 (USART1) for PA9, PA10
 }
 
-/***************************************** Timer11 Configuration ***************************************
- * @brief  Configures TIM11 for delay generation (microsecond/millisecond delays).
- *         Sets prescaler, auto-reload, and enables the timer.
- */
-static void timerConfig()
-{
-    RCC->APB2ENR |= RCC_APB2ENR_TIM11EN;            // Enable TIM11 clock
-
-    TIM11->PSC = PSC_VALUE;                         // Set prescaler for desired timer frequency
-    TIM11->ARR = ARR_VALUE;                         // Set auto-reload (max count)
-    TIM11->CR1 |= 0x1;                              // Enable counter
-
-    while (!(TIM11->SR & 1));                       // Wait for update event flag
-}
-
 /***************************************** Microsecond Delay *******************************************
- * @brief  Generates a delay in microseconds using TIM11.
+ * @brief  Waits for a deadline on the free running TIM5 time base (see Time.c). Nothing is reset,
+ *         so delays can nest or run from interrupts, and other code can keep timing meanwhile.
  *
  * @param  us: Number of microseconds to delay
  */
-void Delay_us(uint16_t us)
+void Delay_us(uint32_t us)
 {
-    TIM11->CNT = 0;                                 // Reset counter
-    while (TIM11->CNT < us);
+    uint32_t deadline = Time_deadline_us(us);
+    while (!Time_expired(deadline));
 }
 
 /***************************************** Millisecond Delay *******************************************
- * @brief  Generates a delay in milliseconds using TIM11.
+ * @brief  Generates a delay in milliseconds. The core sleeps (WFI) until the deadline instead
+ *         of spinning; interrupts keep being served while waiting. Called from an interrupt
+ *         it spins instead (see Time_sleepUntil).
  *
  * @param  ms: Number of milliseconds to delay
  */
-void Delay_ms(uint16_t ms)
+void Delay_ms(uint32_t ms)
 {
-    for (uint16_t i=0; i<ms; i++)
+    uint32_t deadline = Time_now_us();
+
+    while (ms)
     {
-        Delay_us(1000);                             // 1ms = 1000us
+        uint32_t chunk = (ms > 1000000) ? 1000000 : ms;     // Deadlines stay within the 32-bit range
+        deadline += chunk * 1000;                           // 1ms = 1000us
+        Time_sleepUntil(deadline);
+        ms -= chunk;
     }
 }
 
@@ -119,15 +115,44 @@ void Delay_ms(uint16_t ms)
  */
 void SystemInit(void)
 {
-    SysClockConfig_42Mhz();                         // Configure system clock to 42MHz
+    Clock_init(CLOCK_SYSCLK);                       // Configure system clock to 84MHz (Clock.h)
     gpioConfig();                                   // Configure GPIOA/B for SPI and UART
-    timerConfig();                                  // Configure TIM11 for delays
+    Time_init();                                    // Start the TIM5 microsecond time base
+    #if PROFILE_ENABLE
+    Profile_init();                                 // DWT cycle counter and latency probe
+    #endif
+    #if LOAD_ENABLE
+    Load_init();                                    // CPU load sampled from the idle time
+    #endif
+    #if TRACE_ENABLE
+    Trace_init();                                   // Driver event trace in RAM
+    #endif
 }
 
 /************************************ SystemCoreClockUpdate ********************************************
- * @brief  Stub for updating SystemCoreClock variable (if used).
+ * @brief  Updates SystemCoreClock from the running clock tree (SYSCLK source, PLL factors
+ *         and AHB prescaler). Clock_init calls it after every change.
  */
 void SystemCoreClockUpdate(void)
 {
-    // Typically updates SystemCoreClock variable, if used by CMSIS or HAL
-}
\ No newline at end of file
+    uint32_t source = RCC->CFGR & RCC_CFGR_SWS;
+    uint32_t sysclk = CLOCK_HSI;
+
+    if (source == RCC_CFGR_SWS_HSE)
+    {
+        sysclk = CLOCK_HSE;
+    }
+    else if (source == RCC_CFGR_SWS_PLL)
+    {
+        uint32_t pllcfgr = RCC->PLLCFGR;
+        uint32_t input = (pllcfgr & RCC_PLLCFGR_PLLSRC) ? CLOCK_HSE : CLOCK_HSI;
+        uint32_t m = (pllcfgr & RCC_PLLCFGR_PLLM) >> RCC_PLLCFGR_PLLM_Pos;
+        uint32_t n = (pllcfgr & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+        uint32_t p = (((pllcfgr & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1) * 2;
+
+        sysclk = (input / m) * n / p;
+    }
+
+    uint32_t hpre = (RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos;     // 0xxx: /1, 1000-1111: /2../512
+    SystemCoreClock = (hpre & 0x8) ? sysclk >> ahbShift[hpre & 0x7] : sysclk;
+}
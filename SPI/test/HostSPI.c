@@ -0,0 +1,103 @@
+#include <string.h>
+#include "HostSPI.h"
+
+RCC_TypeDef hostRCC;
+GPIO_TypeDef hostGPIOA;
+SPI_TypeDef hostSPI;
+DWT_Type hostDWT;
+CoreDebug_Type hostCoreDebug;
+uint32_t SystemCoreClock = 84000000;
+uint32_t hostFailures;
+uint32_t hostSPIFrequency;
+
+static const HostSPI_Device_Typedef* device;
+static uint8_t selected;
+static uint8_t prescaler;
+
+/**
+ * @brief  Connects a device model and starts from an idle bus (CS high, SR clear).
+ */
+void HostSPI_Attach(const HostSPI_Device_Typedef* model)
+{
+    device = model;
+    selected = 0;
+    memset(&hostGPIOA, 0, sizeof(hostGPIOA));
+    memset(&hostSPI, 0, sizeof(hostSPI));
+}
+
+/**
+ * @brief  Applies the chip select writes made since the last call. A driver writes BSRR once
+ *         per edge, so a CS low request while still selected means the CS high in between was
+ *         overwritten before any byte was clocked: both edges are passed on.
+ */
+void HostSPI_Sync(void)
+{
+    uint32_t bsrr = hostGPIOA.BSRR;
+
+    hostGPIOA.BSRR = 0;
+    if (bsrr & (1U << (HOST_CS_PIN + 16)))
+    {
+        if (selected)
+        {
+            device->select(0);
+        }
+        selected = 1;
+        device->select(1);
+    }
+    else if ((bsrr & (1U << HOST_CS_PIN)) && selected)
+    {
+        selected = 0;
+        device->select(0);
+    }
+}
+
+/********************************** SPI.c replacements ****************************************/
+void SPI_Enable(SPI_TypeDef* SPI)
+{
+    (void)SPI;
+}
+
+void SPI_Disable(SPI_TypeDef* SPI)
+{
+    (void)SPI;
+}
+
+void SPI_SetPrescaler(SPI_TypeDef* SPI, uint8_t baudRatePrescaler)
+{
+    (void)SPI;
+    prescaler = baudRatePrescaler;
+    hostSPIFrequency = HOST_BUS_CLOCK >> (prescaler + 1);
+}
+
+uint8_t SPI_GetPrescaler(SPI_TypeDef* SPI, uint32_t maxFrequency)
+{
+    uint8_t value = PRE_2;
+
+    (void)SPI;
+    while (value < PRE_256 && (HOST_BUS_CLOCK >> (value + 1)) > maxFrequency)
+    {
+        value++;
+    }
+    return value;
+}
+
+uint8_t SPI_TransferBlock(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length)
+{
+    (void)SPI;
+    HostSPI_Sync();
+    for (uint16_t i = 0; i < length; i++)
+    {
+        uint8_t miso = device->exchange(selected, txData ? txData[i] : 0xFF);
+        if (rxData)
+        {
+            rxData[i] = miso;
+        }
+        hostDWT.CYCCNT += 8 * HOST_CYCLES_PER_BIT << prescaler;
+    }
+    return SPI_OK;
+}
+
+uint8_t SPI_TransferBlock_DMA(SPI_TypeDef* SPI, const uint8_t* txData, uint8_t* rxData, uint16_t length)
+{
+    return SPI_TransferBlock(SPI, txData, rxData, length);
+}
@@ -0,0 +1,26 @@
+#ifndef HOST_SPI_H_
+#define HOST_SPI_H_
+
+#include <stdint.h>
+#include "SPI.h"
+
+// host replacement of SPI.c: every byte a driver clocks is handed to the attached device model
+// together with the chip select level, which is read back from the writes to hostGPIOA->BSRR
+#define HOST_CS_PIN         4
+#define HOST_BUS_CLOCK      42000000        // APB clock used for the prescalers (SPI_GetPrescaler)
+#define HOST_CYCLES_PER_BIT 2               // DWT cycles charged per SCK period at PRE_2
+
+// use declared struct to plug a device model on the bus
+typedef struct
+{
+    void (*select)(uint8_t selected);               // Chip select edge
+    uint8_t (*exchange)(uint8_t selected, uint8_t mosi);    // One byte clocked, returns MISO
+}HostSPI_Device_Typedef;
+
+extern uint32_t hostSPIFrequency;           // SCK set by the last SPI_SetPrescaler
+
+// function declaration
+void HostSPI_Attach(const HostSPI_Device_Typedef* device);
+void HostSPI_Sync(void);
+
+#endif
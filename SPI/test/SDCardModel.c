@@ -0,0 +1,384 @@
+#include <string.h>
+#include "SDCardModel.h"
+
+SDModel_Typedef sdModel;
+
+#define R1_IDLE             0x01
+#define R1_ILLEGAL          0x04
+#define R1_CRC_ERROR        0x08
+#define R1_ADDRESS_ERROR    0x20
+#define R1_PARAMETER_ERROR  0x40
+
+/************************************** CRC helpers *******************************************
+ * @brief  CRC7 of command frames (x^7 + x^3 + 1) and CRC16-CCITT of data blocks (x^16 + x^12
+ *         + x^5 + 1), both MSB first with initial value 0, as in the SD physical layer spec.
+ */
+uint8_t SDModel_CRC7(const uint8_t* data, uint8_t length)
+{
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        for (int8_t bit = 7; bit >= 0; bit--)
+        {
+            uint8_t feedback = ((crc >> 6) ^ (data[i] >> bit)) & 1;
+            crc = (uint8_t)((crc << 1) & 0x7F);
+            if (feedback)
+            {
+                crc ^= 0x09;
+            }
+        }
+    }
+    return crc;
+}
+
+uint16_t SDModel_CRC16(const uint8_t* data, uint16_t length)
+{
+    uint16_t crc = 0;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*************************************** MISO queue *******************************************/
+static void SDModel_Push(uint8_t byte)
+{
+    sdModel.out[sdModel.outTail++ % sizeof(sdModel.out)] = byte;
+}
+
+static void SDModel_Response(uint8_t r1)
+{
+    for (uint8_t i = 0; i < SDMODEL_NCR; i++)
+    {
+        SDModel_Push(0xFF);
+    }
+    SDModel_Push(r1);
+}
+
+/**
+ * @brief  Queues a data block: read delay, start token, payload, CRC16.
+ */
+static void SDModel_PushBlock(const uint8_t* data, uint16_t length)
+{
+    uint16_t crc = SDModel_CRC16(data, length);
+
+    for (uint8_t i = 0; i < SDMODEL_READ_DELAY; i++)
+    {
+        SDModel_Push(0xFF);
+    }
+    SDModel_Push(0xFE);
+    for (uint16_t i = 0; i < length; i++)
+    {
+        SDModel_Push(data[i]);
+    }
+    SDModel_Push(crc >> 8);
+    SDModel_Push(crc & 0xFF);
+}
+
+/**
+ * @brief  CSD register: version 2.0 for SDHC, version 1.0 (READ_BL_LEN 9) for SDSC.
+ */
+static void SDModel_PushCSD(void)
+{
+    uint8_t csd[16] = { 0 };
+
+    if (sdModel.type == SDMODEL_SDHC)
+    {
+        uint32_t cSize = SDMODEL_SECTORS / 1024 - 1;
+        csd[0] = 0x40;
+        csd[7] = (cSize >> 16) & 0x3F;
+        csd[8] = (cSize >> 8) & 0xFF;
+        csd[9] = cSize & 0xFF;
+    }
+    else
+    {
+        uint32_t cSize = SDMODEL_SECTORS / 4 - 1;  // C_SIZE_MULT 0: (C_SIZE + 1) * 4 blocks
+        csd[5] = 0x09;
+        csd[6] = (cSize >> 10) & 0x03;
+        csd[7] = (cSize >> 2) & 0xFF;
+        csd[8] = (cSize & 0x03) << 6;
+    }
+    csd[15] = (SDModel_CRC7(csd, 15) << 1) | 1;
+    SDModel_PushBlock(csd, 16);
+}
+
+/**
+ * @brief  Sector of a data command: SDHC arguments are block numbers, SDSC byte addresses.
+ * @return R1 error bits, 0 if the sector exists
+ */
+static uint8_t SDModel_Address(uint32_t argument)
+{
+    if (sdModel.type != SDMODEL_SDHC)
+    {
+        if (argument % 512)
+        {
+            return R1_ADDRESS_ERROR;
+        }
+        argument /= 512;
+    }
+    if (argument >= SDMODEL_SECTORS)
+    {
+        return R1_PARAMETER_ERROR;
+    }
+    sdModel.sector = argument;
+    return 0;
+}
+
+/**
+ * @brief  Complete command frame received with CS low.
+ */
+static void SDModel_Command(void)
+{
+    uint8_t index = sdModel.frame[0] & 0x3F;
+    uint32_t argument = ((uint32_t)sdModel.frame[1] << 24) | ((uint32_t)sdModel.frame[2] << 16)
+                        | ((uint32_t)sdModel.frame[3] << 8) | sdModel.frame[4];
+    uint8_t crcOk = sdModel.frame[5] == ((SDModel_CRC7(sdModel.frame, 5) << 1) | 1);
+    uint8_t app = sdModel.appCommand;
+    uint8_t r1;
+
+    sdModel.appCommand = 0;
+    if (!sdModel.spiMode)
+    {
+        // SD mode: only a CMD0 with a good CRC after 74 clocks switches to SPI mode
+        if (index != 0 || !crcOk || sdModel.clocksHigh < 10)
+        {
+            return;
+        }
+        sdModel.spiMode = 1;
+    }
+    if (sdModel.idle && hostSPIFrequency > 400000)
+    {
+        sdModel.slowViolations++;
+    }
+    if ((index == 0 || index == 8) && !crcOk)
+    {
+        sdModel.crcErrors++;                    // CRC is checked for these two even in SPI mode
+        SDModel_Response(R1_CRC_ERROR | (sdModel.idle ? R1_IDLE : 0));
+        return;
+    }
+    if (app)
+    {
+        sdModel.appCommands[index]++;
+    }
+    else
+    {
+        sdModel.commands[index]++;
+    }
+
+    r1 = sdModel.idle ? R1_IDLE : 0;
+    switch (app ? 0x40 | index : index)
+    {
+    case 0:
+        sdModel.idle = 1;
+        sdModel.acmd41Count = 0;
+        SDModel_Response(R1_IDLE);
+        break;
+    case 8:
+        if (sdModel.type == SDMODEL_SDSC_V1)
+        {
+            SDModel_Response(r1 | R1_ILLEGAL);
+            break;
+        }
+        SDModel_Response(r1);
+        SDModel_Push(0x00);
+        SDModel_Push(0x00);
+        SDModel_Push((argument >> 8) & 0x0F);   // Voltage accepted: echoed
+        SDModel_Push(argument & 0xFF);          // Check pattern
+        break;
+    case 55:
+        sdModel.appCommand = 1;
+        SDModel_Response(r1);
+        break;
+    case 0x40 | 41:
+        if (sdModel.type != SDMODEL_SDHC || (argument & 0x40000000))
+        {
+            if (++sdModel.acmd41Count > SDMODEL_ACMD41_IDLE)
+            {
+                sdModel.idle = 0;               // SDHC never gets ready without HCS
+            }
+        }
+        SDModel_Response(sdModel.idle ? R1_IDLE : 0);
+        break;
+    case 58:
+        SDModel_Response(r1);
+        SDModel_Push((sdModel.idle ? 0x00 : 0x80) | ((!sdModel.idle && sdModel.type == SDMODEL_SDHC) ? 0x40 : 0x00));
+        SDModel_Push(0xFF);
+        SDModel_Push(0x80);
+        SDModel_Push(0x00);
+        break;
+    case 16:
+        sdModel.blockLength = argument;
+        SDModel_Response(r1 | ((argument == 512) ? 0 : R1_PARAMETER_ERROR));
+        break;
+    case 9:
+        SDModel_Response(r1);
+        if (!sdModel.idle)
+        {
+            SDModel_PushCSD();
+        }
+        break;
+    case 0x40 | 23:
+        sdModel.preErase = argument;
+        SDModel_Response(r1);
+        break;
+    case 12:
+        sdModel.reading = 0;
+        sdModel.outHead = sdModel.outTail;      // Stream ends, stuff byte then R1
+        SDModel_Push(0xFF);
+        SDModel_Response(r1);
+        sdModel.busy = SDMODEL_BUSY;
+        break;
+    case 17:
+    case 18:
+    case 24:
+    case 25:
+        r1 |= sdModel.idle ? R1_ILLEGAL : SDModel_Address(argument);
+        SDModel_Response(r1);
+        if (r1)
+        {
+            break;
+        }
+        if (index == 17 || index == 18)
+        {
+            SDModel_PushBlock(sdModel.memory[sdModel.sector++], 512);
+            sdModel.blocksRead++;
+            sdModel.reading = (index == 18);
+        }
+        else
+        {
+            sdModel.writing = (index == 24) ? 1 : 2;
+            sdModel.blockIndex = -1;
+        }
+        break;
+    default:
+        SDModel_Response(r1 | R1_ILLEGAL);
+        break;
+    }
+}
+
+/**
+ * @brief  One byte of a write: start/stop tokens, then 512 data bytes and the CRC16.
+ */
+static void SDModel_WriteByte(uint8_t mosi)
+{
+    if (sdModel.blockIndex < 0)
+    {
+        if (mosi == ((sdModel.writing == 1) ? 0xFE : 0xFC))
+        {
+            sdModel.blockIndex = 0;
+        }
+        else if (sdModel.writing == 2 && mosi == 0xFD)
+        {
+            sdModel.writing = 0;                // Stop token: busy while the last block settles
+            SDModel_Push(0xFF);
+            sdModel.busy = SDMODEL_BUSY;
+        }
+        return;
+    }
+
+    sdModel.block[sdModel.blockIndex++] = mosi;
+    if (sdModel.blockIndex < (int16_t)sizeof(sdModel.block))
+    {
+        return;
+    }
+
+    // CRC is off in SPI mode, so the dummy CRC of the driver is accepted
+    if (sdModel.sector >= SDMODEL_SECTORS)
+    {
+        SDModel_Push(0xED);                     // Write error
+        sdModel.writing = 0;
+        return;
+    }
+    memcpy(sdModel.memory[sdModel.sector++], sdModel.block, 512);
+    sdModel.blocksWritten++;
+    SDModel_Push(0xE5);                         // Data accepted
+    sdModel.busy = SDMODEL_BUSY;
+    sdModel.blockIndex = -1;
+    if (sdModel.writing == 1)
+    {
+        sdModel.writing = 0;
+    }
+}
+
+/**
+ * @brief  Deselect releases MISO and drops the queued bytes; a CS edge ends a command frame.
+ */
+static void SDModel_Select(uint8_t selected)
+{
+    sdModel.frameIndex = 0;
+    if (!selected)
+    {
+        sdModel.outHead = sdModel.outTail;
+        sdModel.reading = 0;
+    }
+}
+
+static uint8_t SDModel_Exchange(uint8_t selected, uint8_t mosi)
+{
+    uint8_t miso = 0xFF;
+
+    if (!sdModel.present)
+    {
+        return 0xFF;
+    }
+    if (!selected)
+    {
+        if (!sdModel.spiMode)
+        {
+            sdModel.clocksHigh++;
+        }
+        return 0xFF;
+    }
+
+    if (sdModel.outHead != sdModel.outTail)
+    {
+        miso = sdModel.out[sdModel.outHead++ % sizeof(sdModel.out)];
+    }
+    else if (sdModel.busy)
+    {
+        sdModel.busy--;
+        miso = 0x00;
+    }
+
+    if (sdModel.reading && sdModel.outHead == sdModel.outTail && sdModel.sector < SDMODEL_SECTORS)
+    {
+        SDModel_PushBlock(sdModel.memory[sdModel.sector++], 512);    // Next block of the stream
+        sdModel.blocksRead++;
+    }
+
+    if (sdModel.writing && sdModel.frameIndex == 0)
+    {
+        SDModel_WriteByte(mosi);
+    }
+    else if (sdModel.frameIndex || (mosi & 0xC0) == 0x40)
+    {
+        sdModel.frame[sdModel.frameIndex++] = mosi;
+        if (sdModel.frameIndex == sizeof(sdModel.frame))
+        {
+            sdModel.frameIndex = 0;
+            SDModel_Command();
+        }
+    }
+    return miso;
+}
+
+/**
+ * @brief  Powered up card of the given type, zero-filled, attached to the host SPI bus.
+ */
+void SDModel_Attach(uint8_t type)
+{
+    static const HostSPI_Device_Typedef device = { SDModel_Select, SDModel_Exchange };
+
+    memset(&sdModel, 0, sizeof(sdModel));
+    sdModel.type = type;
+    sdModel.present = 1;
+    sdModel.idle = 1;
+    HostSPI_Attach(&device);
+}
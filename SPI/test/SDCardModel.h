@@ -0,0 +1,64 @@
+#ifndef SD_CARD_MODEL_H_
+#define SD_CARD_MODEL_H_
+
+#include <stdint.h>
+#include "HostSPI.h"
+
+#define SDMODEL_SECTORS     2048            // 1 MB card
+#define SDMODEL_NCR         1               // Filler bytes before every R1
+#define SDMODEL_READ_DELAY  2               // Filler bytes before every read data token
+#define SDMODEL_BUSY        4               // Busy bytes after every written block or stop
+#define SDMODEL_ACMD41_IDLE 3               // ACMD41 answered idle this many times
+
+// use declared enum to select the emulated card
+enum SDModel_type
+{
+    SDMODEL_SDHC,                           // Version 2, block addressed, CSD 2.0
+    SDMODEL_SDSC_V2,                        // Version 2, byte addressed, CSD 1.0
+    SDMODEL_SDSC_V1                         // CMD8 illegal, byte addressed, CSD 1.0
+};
+
+// use declared struct to inspect the card after a driver call
+typedef struct
+{
+    uint8_t type;
+    uint8_t present;                        // 0: MISO stays high
+    uint8_t memory[SDMODEL_SECTORS][512];
+
+    // protocol state
+    uint32_t clocksHigh;                    // Bytes clocked with CS high before SPI mode
+    uint8_t spiMode;
+    uint8_t idle;                           // Initialization not finished (R1 idle bit)
+    uint8_t appCommand;                     // CMD55 received, next command is ACMDx
+    uint32_t acmd41Count;
+    uint8_t frame[6];
+    uint8_t frameIndex;
+    uint8_t out[1024];                      // Bytes queued on MISO
+    uint16_t outHead;
+    uint16_t outTail;
+    uint32_t busy;                          // MISO held low (programming) once the queue drains
+    uint8_t reading;                        // CMD18 stream running
+    uint32_t sector;                        // Next sector of the running read or write
+    uint8_t writing;                        // 0 none, 1 CMD24, 2 CMD25
+    uint8_t block[514];                     // Write block being received (data and CRC)
+    int16_t blockIndex;                     // -1: waiting for the start token
+
+    // counters
+    uint32_t commands[64];                  // CMDx received, by index
+    uint32_t appCommands[64];               // ACMDx received, by index
+    uint32_t crcErrors;                     // CMD0/CMD8 frames with a wrong CRC7
+    uint32_t slowViolations;                // Identification commands above 400 kHz
+    uint32_t blocksRead;
+    uint32_t blocksWritten;
+    uint32_t preErase;                      // Last ACMD23 argument
+    uint32_t blockLength;                   // Last CMD16 argument
+}SDModel_Typedef;
+
+extern SDModel_Typedef sdModel;
+
+// function declaration
+void SDModel_Attach(uint8_t type);
+uint8_t SDModel_CRC7(const uint8_t* data, uint8_t length);
+uint16_t SDModel_CRC16(const uint8_t* data, uint16_t length);
+
+#endif
@@ -0,0 +1,159 @@
+#include <string.h>
+#include "W25QModel.h"
+
+W25Q_Model_Typedef w25q;
+
+/**
+ * @brief  Page program at CS high: latched bytes only clear bits (program without erase is AND).
+ *         Bytes past the end of the page wrapped to its start in the latch, as on the chip.
+ */
+static void W25Q_Program(void)
+{
+    uint32_t base = w25q.address & ~0xFFUL;
+
+    if ((w25q.address & 0xFF) + w25q.pageBytes > 256)
+    {
+        w25q.pageWraps++;
+    }
+    for (uint32_t column = 0; column < 256; column++)
+    {
+        w25q.memory[base + column] &= w25q.page[column];    // Unlatched columns hold 0xFF
+    }
+    w25q.programs++;
+    w25q.busy = W25Q_PROGRAM_POLLS;
+}
+
+static void W25Q_Erase(uint32_t size, uint32_t polls)
+{
+    memset(&w25q.memory[w25q.address & ~(size - 1)], 0xFF, size);   // Address bits below size ignored
+    w25q.busy = polls;
+}
+
+/**
+ * @brief  CS edges: CS high executes program/erase commands, which need WEL and an exact length.
+ */
+static void W25Q_Select(uint8_t selected)
+{
+    if (selected)
+    {
+        w25q.index = 0;
+        w25q.pageBytes = 0;
+        memset(w25q.page, 0xFF, sizeof(w25q.page));
+        return;
+    }
+
+    switch (w25q.command)
+    {
+    case 0x06:
+        w25q.wel = (w25q.index == 1);
+        break;
+    case 0x02:
+    case 0x20:
+    case 0x52:
+    case 0xD8:
+        if (!w25q.wel || w25q.index < 4 || (w25q.command != 0x02 && w25q.index != 4))
+        {
+            w25q.violations++;
+            break;
+        }
+        if (w25q.command == 0x02)
+        {
+            W25Q_Program();
+        }
+        else if (w25q.command == 0x20)
+        {
+            W25Q_Erase(0x1000, W25Q_ERASE_4K_POLLS);
+            w25q.erase4K++;
+        }
+        else if (w25q.command == 0x52)
+        {
+            W25Q_Erase(0x8000, W25Q_ERASE_32K_POLLS);
+            w25q.erase32K++;
+        }
+        else
+        {
+            W25Q_Erase(0x10000, W25Q_ERASE_64K_POLLS);
+            w25q.erase64K++;
+        }
+        w25q.wel = 0;
+        break;
+    default:
+        break;
+    }
+    w25q.command = 0;
+}
+
+/**
+ * @brief  One byte with CS low. While WIP is set only the status register answers.
+ */
+static uint8_t W25Q_Exchange(uint8_t selected, uint8_t mosi)
+{
+    uint32_t index = w25q.index++;
+    uint8_t miso = 0xFF;
+
+    if (!selected)
+    {
+        return 0xFF;
+    }
+    if (index == 0)
+    {
+        w25q.command = mosi;
+        if (w25q.busy && mosi != 0x05)
+        {
+            w25q.violations++;
+            w25q.command = 0;                   // Ignored by the chip
+        }
+        return 0xFF;
+    }
+
+    switch (w25q.command)
+    {
+    case 0x9F:
+        miso = (index == 1) ? 0xEF : (index == 2) ? 0x40 : (index == 3) ? W25Q_CAPACITY_CODE : 0xFF;
+        break;
+    case 0x05:
+        miso = (w25q.busy ? 0x01 : 0x00) | (w25q.wel << 1);
+        if (w25q.busy)
+        {
+            w25q.busy--;
+        }
+        break;
+    case 0x0B:
+    case 0x02:
+    case 0x20:
+    case 0x52:
+    case 0xD8:
+        if (index <= 3)
+        {
+            w25q.address = (index == 1) ? mosi : (w25q.address << 8) | mosi;
+            if (index == 3)
+            {
+                w25q.address %= W25Q_CAPACITY;  // Upper address bits ignored
+            }
+        }
+        else if (w25q.command == 0x0B && index >= 5)
+        {
+            miso = w25q.memory[(w25q.address + index - 5) % W25Q_CAPACITY];
+        }
+        else if (w25q.command == 0x02)
+        {
+            w25q.page[(w25q.address + w25q.pageBytes++) & 0xFF] = mosi;
+        }
+        break;
+    default:
+        break;
+    }
+    return miso;
+}
+
+/**
+ * @brief  Erased chip, idle, counters cleared, attached to the host SPI bus.
+ */
+void W25Q_Attach(void)
+{
+    static const HostSPI_Device_Typedef device = { W25Q_Select, W25Q_Exchange };
+
+    memset(&w25q, 0, sizeof(w25q));
+    memset(w25q.memory, 0xFF, sizeof(w25q.memory));
+    HostSPI_Attach(&device);
+}
@@ -0,0 +1,45 @@
+#ifndef W25Q_MODEL_H_
+#define W25Q_MODEL_H_
+
+#include <stdint.h>
+#include "HostSPI.h"
+
+// W25Q10-like chip: 128 KB, JEDEC ID EF 40 11
+#define W25Q_CAPACITY_CODE  0x11
+#define W25Q_CAPACITY       (1UL << W25Q_CAPACITY_CODE)
+
+// write in progress, counted in status register reads instead of microseconds
+#define W25Q_PROGRAM_POLLS  3
+#define W25Q_ERASE_4K_POLLS 8
+#define W25Q_ERASE_32K_POLLS 20
+#define W25Q_ERASE_64K_POLLS 30
+
+// use declared struct to inspect the model after a driver call
+typedef struct
+{
+    uint8_t memory[W25Q_CAPACITY];
+    uint8_t wel;                        // Write enable latch
+    uint32_t busy;                      // Status reads left with WIP set
+
+    // current command (CS low)
+    uint8_t command;
+    uint32_t index;                     // Bytes clocked since CS low
+    uint32_t address;
+    uint8_t page[256];                  // Page program latch, wraps within the page
+    uint32_t pageBytes;
+
+    // counters
+    uint32_t programs;
+    uint32_t erase4K;
+    uint32_t erase32K;
+    uint32_t erase64K;
+    uint32_t pageWraps;                 // Page programs longer than the rest of the page
+    uint32_t violations;                // Commands refused by a real chip (busy, no WEL, bad length)
+}W25Q_Model_Typedef;
+
+extern W25Q_Model_Typedef w25q;
+
+// function declaration
+void W25Q_Attach(void);
+
+#endif
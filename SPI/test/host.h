@@ -0,0 +1,39 @@
+#ifndef HOST_H_
+#define HOST_H_
+
+// Forced into every host test build (gcc -include): the device header is read once for its
+// types and bit definitions, then the peripherals touched outside SPI.c are moved to RAM.
+
+#include <stdint.h>
+#include <stdio.h>
+#include "stm32f401xc.h"
+
+extern RCC_TypeDef hostRCC;
+extern GPIO_TypeDef hostGPIOA;
+extern SPI_TypeDef hostSPI;
+extern DWT_Type hostDWT;
+extern CoreDebug_Type hostCoreDebug;
+
+#undef RCC
+#define RCC                 (&hostRCC)
+#undef GPIOA_BASE
+#define GPIOA_BASE          ((uint32_t)(uintptr_t)&hostGPIOA)
+#undef DWT
+#define DWT                 (&hostDWT)
+#undef CoreDebug
+#define CoreDebug           (&hostCoreDebug)
+
+// test bookkeeping: CHECK records a failure and carries on, the main returns the count
+extern uint32_t hostFailures;
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            hostFailures++;                                                     \
+        }                                                                       \
+    } while (0)
+
+#endif
@@ -0,0 +1,197 @@
+#include <string.h>
+#include "SDCard.h"
+#include "SDCardModel.h"
+
+static SDCard_Typedef card;
+static uint8_t pattern[5 * SDCARD_SECTOR_SIZE];
+static uint8_t readBack[5 * SDCARD_SECTOR_SIZE];
+
+/**
+ * @brief  Powered card of the given type and a driver descriptor; returns SDCard_init.
+ */
+static uint8_t Setup(uint8_t type)
+{
+    SDModel_Attach(type);
+    card = (SDCard_Typedef){ .SPI = &hostSPI, .csPort = &hostGPIOA, .csPin = HOST_CS_PIN };
+
+    for (uint32_t i = 0; i < sizeof(pattern); i++)
+    {
+        pattern[i] = (uint8_t)(i * 13 + i / 512);
+    }
+    return SDCard_init(&card);
+}
+
+/**
+ * @brief  Identification on an SDHC card: slow clock until ACMD41 completes, fast clock after,
+ *         capacity from CSD 2.0.
+ */
+static void Test_InitSDHC(void)
+{
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    CHECK(card.type == SD_TYPE_SDHC);
+    CHECK(card.sectorCount == SDMODEL_SECTORS);
+    CHECK(sdModel.slowViolations == 0);
+    CHECK(hostSPIFrequency == HOST_BUS_CLOCK / 2);          // 21 MHz for data transfer
+    CHECK(sdModel.appCommands[41] == SDMODEL_ACMD41_IDLE + 1);
+    CHECK(sdModel.commands[16] == 0);                       // Block length fixed on SDHC
+}
+
+/**
+ * @brief  Byte addressed cards: version 2 without CCS and version 1 (CMD8 illegal) both get
+ *         CMD16 and a capacity from CSD 1.0.
+ */
+static void Test_InitSDSC(void)
+{
+    CHECK(Setup(SDMODEL_SDSC_V2) == SD_OK);
+    CHECK(card.type == SD_TYPE_SDSC_V2);
+    CHECK(card.sectorCount == SDMODEL_SECTORS);
+    CHECK(sdModel.blockLength == SDCARD_SECTOR_SIZE);
+
+    CHECK(Setup(SDMODEL_SDSC_V1) == SD_OK);
+    CHECK(card.type == SD_TYPE_SDSC_V1);
+    CHECK(card.sectorCount == SDMODEL_SECTORS);
+    CHECK(sdModel.slowViolations == 0);
+}
+
+static void Test_NoCard(void)
+{
+    SDModel_Attach(SDMODEL_SDHC);
+    sdModel.present = 0;
+    card = (SDCard_Typedef){ .SPI = &hostSPI, .csPort = &hostGPIOA, .csPin = HOST_CS_PIN };
+    CHECK(SDCard_init(&card) == SD_NO_CARD);
+    CHECK(SDCard_ReadSectors(&card, 0, readBack, 1) == SD_NO_CARD);
+}
+
+/**
+ * @brief  Command CRCs: the card checks CMD0 and CMD8 even in SPI mode, so identification only
+ *         succeeds with the right CRC7 bytes; a corrupted CMD8 is answered with the CRC error bit.
+ */
+static void Test_CommandCRC(void)
+{
+    static const uint8_t cmd0[5] = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t cmd8[5] = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+    uint8_t frame[6] = { 0x48, 0x00, 0x00, 0x01, 0xAA, 0x87 ^ 0x02 };
+    uint8_t response[2];
+
+    CHECK(((SDModel_CRC7(cmd0, 5) << 1) | 1) == 0x95);
+    CHECK(((SDModel_CRC7(cmd8, 5) << 1) | 1) == 0x87);
+
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    CHECK(sdModel.crcErrors == 0);
+
+    hostGPIOA.BSRR = 1U << (HOST_CS_PIN + 16);
+    SPI_TransferBlock(&hostSPI, frame, 0, sizeof(frame));
+    SPI_TransferBlock(&hostSPI, 0, response, sizeof(response));
+    hostGPIOA.BSRR = 1U << HOST_CS_PIN;
+    HostSPI_Sync();
+    CHECK(sdModel.crcErrors == 1);
+    CHECK(response[SDMODEL_NCR] & 0x08);
+}
+
+/**
+ * @brief  Read data blocks carry a valid CRC16 (the driver discards it), and single and
+ *         multi-block reads return the card content.
+ */
+static void Test_Read(void)
+{
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    memcpy(sdModel.memory[40], pattern, sizeof(pattern));
+
+    CHECK(SDCard_ReadSectors(&card, 40, readBack, 1) == SD_OK);
+    CHECK(memcmp(readBack, pattern, SDCARD_SECTOR_SIZE) == 0);
+    CHECK(sdModel.commands[17] == 1);
+
+    memset(readBack, 0, sizeof(readBack));
+    CHECK(SDCard_ReadSectors(&card, 40, readBack, 5) == SD_OK);
+    CHECK(memcmp(readBack, pattern, sizeof(pattern)) == 0);
+    CHECK(sdModel.commands[18] == 1);
+    CHECK(sdModel.commands[12] == 1);
+    CHECK(sdModel.reading == 0);
+
+}
+
+/**
+ * @brief  Zero counts and ranges past the card, including those whose end wraps 32 bits, are
+ *         refused before any command reaches the card.
+ */
+static void Test_Bounds(void)
+{
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    memset(readBack, 0x5A, sizeof(readBack));
+
+    CHECK(SDCard_ReadSectors(&card, 0, readBack, 0) == SD_BAD_ARGUMENT);
+    CHECK(readBack[0] == 0x5A);                             // Caller's buffer untouched
+    CHECK(SDCard_WriteSectors(&card, 0, pattern, 0) == SD_BAD_ARGUMENT);
+    CHECK(SDCard_ReadSectors(&card, SDMODEL_SECTORS, readBack, 1) == SD_BAD_ARGUMENT);
+    CHECK(SDCard_ReadSectors(&card, SDMODEL_SECTORS - 1, readBack, 2) == SD_BAD_ARGUMENT);
+    CHECK(SDCard_WriteSectors(&card, 0xFFFFFFFF, pattern, 2) == SD_BAD_ARGUMENT);
+    CHECK(sdModel.commands[17] + sdModel.commands[18] + sdModel.commands[24] + sdModel.commands[25] == 0);
+    CHECK(sdModel.appCommands[23] == 0);
+
+    CHECK(SDCard_ReadSectors(&card, SDMODEL_SECTORS - 1, readBack, 1) == SD_OK);
+    CHECK(SDCard_WriteSectors(&card, SDMODEL_SECTORS - 2, pattern, 2) == SD_OK);
+}
+
+/**
+ * @brief  Single block write (CMD24) and multi-block write (ACMD23 + CMD25, stop token), on a
+ *         block addressed and on a byte addressed card.
+ */
+static void Test_Write(void)
+{
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    CHECK(SDCard_WriteSectors(&card, 7, pattern, 1) == SD_OK);
+    CHECK(memcmp(sdModel.memory[7], pattern, SDCARD_SECTOR_SIZE) == 0);
+    CHECK(sdModel.commands[24] == 1);
+
+    CHECK(SDCard_WriteSectors(&card, 100, pattern, 5) == SD_OK);
+    CHECK(sdModel.commands[25] == 1);
+    CHECK(sdModel.appCommands[23] == 1);
+    CHECK(sdModel.preErase == 5);
+    CHECK(sdModel.blocksWritten == 6);
+    CHECK(sdModel.writing == 0);                            // Stop token seen
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        CHECK(memcmp(sdModel.memory[100 + i], &pattern[i * SDCARD_SECTOR_SIZE], SDCARD_SECTOR_SIZE) == 0);
+    }
+
+    CHECK(Setup(SDMODEL_SDSC_V2) == SD_OK);
+    CHECK(SDCard_WriteSectors(&card, 3, pattern, 2) == SD_OK);  // Byte address 1536
+    CHECK(memcmp(sdModel.memory[3], pattern, 2 * SDCARD_SECTOR_SIZE) == 0);
+    CHECK(SDCard_ReadSectors(&card, 3, readBack, 2) == SD_OK);
+    CHECK(memcmp(readBack, pattern, 2 * SDCARD_SECTOR_SIZE) == 0);
+}
+
+/**
+ * @brief  Benchmark: a zero transfer unit is refused instead of looping forever; a normal run
+ *         moves the whole area and reports both rates.
+ */
+static void Test_Benchmark(void)
+{
+    SDCard_Bench_Typedef result;
+
+    CHECK(Setup(SDMODEL_SDHC) == SD_OK);
+    SDCard_Benchmark(&card, 0, readBack, 0, 10, &result);
+    CHECK(result.status == SD_BAD_ARGUMENT);
+
+    SDCard_Benchmark(&card, 0, readBack, 4, 10, &result);  // 4 + 4 + 2 sectors
+    CHECK(result.status == SD_OK);
+    CHECK(result.writeBytesPerSec > 0);
+    CHECK(result.readBytesPerSec > 0);
+    CHECK(sdModel.commands[25] == 3);
+    CHECK(sdModel.commands[18] == 3);
+}
+
+int main(void)
+{
+    Test_InitSDHC();
+    Test_InitSDSC();
+    Test_NoCard();
+    Test_CommandCRC();
+    Test_Read();
+    Test_Write();
+    Test_Bounds();
+    Test_Benchmark();
+
+    printf("SDCard: %s (%u failures)\n", hostFailures ? "FAIL" : "ok", (unsigned)hostFailures);
+    return hostFailures ? 1 : 0;
+}
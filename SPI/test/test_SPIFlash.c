@@ -0,0 +1,143 @@
+#include <string.h>
+#include "SPIFlash.h"
+#include "W25QModel.h"
+
+static SPIFlash_Typedef flash;
+static uint8_t pattern[3 * SPIFLASH_PAGE_SIZE];
+static uint8_t readBack[3 * SPIFLASH_PAGE_SIZE];
+
+/**
+ * @brief  Fresh erased chip and an initialized driver.
+ */
+static void Setup(void)
+{
+    W25Q_Attach();
+    flash = (SPIFlash_Typedef){ .SPI = &hostSPI, .csPort = &hostGPIOA, .csPin = HOST_CS_PIN };
+    CHECK(SPIFlash_init(&flash) == SPIFLASH_OK);
+
+    for (uint32_t i = 0; i < sizeof(pattern); i++)
+    {
+        pattern[i] = (uint8_t)(i * 7 + 3);
+    }
+}
+
+/**
+ * @brief  Lets the model see the CS high of the last command and checks the protocol.
+ */
+static void Finish(void)
+{
+    SPIFlash_WaitReady(&flash);
+    HostSPI_Sync();
+    CHECK(w25q.violations == 0);
+    CHECK(w25q.pageWraps == 0);
+}
+
+static void Test_Init(void)
+{
+    Setup();
+    CHECK(flash.jedecID == 0xEF4011);
+    CHECK(flash.capacity == W25Q_CAPACITY);
+    Finish();
+}
+
+/**
+ * @brief  Unaligned write across three page boundaries: split into 4 page programs, each one
+ *         issued only after the previous one left WIP.
+ */
+static void Test_WritePageSplit(void)
+{
+    uint32_t address = 0x1F0;
+    uint32_t length = 600;                      // 16 + 256 + 256 + 72
+
+    Setup();
+    CHECK(SPIFlash_Write(&flash, address, pattern, length) == SPIFLASH_OK);
+    CHECK(flash.busy == 1);                     // Returns while the last page programs
+    CHECK(flash.stats.pagePrograms == 4);
+
+    CHECK(SPIFlash_Read(&flash, address, readBack, length) == SPIFLASH_OK);
+    CHECK(memcmp(readBack, pattern, length) == 0);
+    CHECK(w25q.memory[address - 1] == 0xFF);
+    CHECK(w25q.memory[address + length] == 0xFF);
+    CHECK(w25q.programs == 4);
+    CHECK(flash.stats.busyPolls > 0);           // WIP was seen and waited for
+    Finish();
+}
+
+/**
+ * @brief  Erase of an unaligned range: rounded out to 4K, 32K and 64K blocks where aligned,
+ *         and nothing outside the rounded range is touched.
+ */
+static void Test_EraseGranularity(void)
+{
+    Setup();
+    memset(w25q.memory, 0x00, sizeof(w25q.memory));
+
+    CHECK(SPIFlash_Erase(&flash, 0x1800, 0x1E800) == SPIFLASH_OK);     // 0x1000 .. 0x20000
+    SPIFlash_WaitReady(&flash);
+    HostSPI_Sync();
+    CHECK(w25q.erase4K == 7);                   // 0x1000 .. 0x8000
+    CHECK(w25q.erase32K == 1);                  // 0x8000 .. 0x10000
+    CHECK(w25q.erase64K == 1);                  // 0x10000 .. 0x20000
+    CHECK(flash.stats.bytesErased == 0x1F000);
+
+    CHECK(w25q.memory[0x0FFF] == 0x00);
+    CHECK(w25q.memory[0x1000] == 0xFF);
+    CHECK(w25q.memory[W25Q_CAPACITY - 1] == 0xFF);
+    Finish();
+
+    memset(w25q.memory, 0x00, sizeof(w25q.memory));
+    CHECK(SPIFlash_Erase(&flash, 0x2345, 0) == SPIFLASH_OK);  // Zero length, unaligned
+    Finish();
+    CHECK(w25q.erase4K == 7);                   // No sector erased
+    CHECK(w25q.memory[0x2000] == 0x00);
+    CHECK(w25q.memory[0x2345] == 0x00);
+}
+
+/**
+ * @brief  Erase then program then read back the same sector through the driver only.
+ */
+static void Test_EraseWriteRead(void)
+{
+    Setup();
+    CHECK(SPIFlash_Write(&flash, 0x3000, pattern, sizeof(pattern)) == SPIFLASH_OK);
+    CHECK(SPIFlash_Erase(&flash, 0x3000, 1) == SPIFLASH_OK);
+    CHECK(SPIFlash_Read(&flash, 0x3000, readBack, sizeof(readBack)) == SPIFLASH_OK);
+    for (uint32_t i = 0; i < sizeof(readBack); i++)
+    {
+        CHECK(readBack[i] == 0xFF);
+    }
+
+    CHECK(SPIFlash_Write(&flash, 0x3000, pattern, sizeof(pattern)) == SPIFLASH_OK);
+    CHECK(SPIFlash_Read(&flash, 0x3000, readBack, sizeof(readBack)) == SPIFLASH_OK);
+    CHECK(memcmp(readBack, pattern, sizeof(pattern)) == 0);
+    Finish();
+}
+
+/**
+ * @brief  Ranges ending past the chip are refused, including those whose end wraps 32 bits.
+ */
+static void Test_Bounds(void)
+{
+    Setup();
+    CHECK(SPIFlash_Read(&flash, W25Q_CAPACITY - 16, readBack, 16) == SPIFLASH_OK);
+    CHECK(SPIFlash_Read(&flash, W25Q_CAPACITY - 16, readBack, 17) == SPIFLASH_OUT_OF_RANGE);
+    CHECK(SPIFlash_Read(&flash, 0xFFFFFF00, readBack, 0x200) == SPIFLASH_OUT_OF_RANGE);
+    CHECK(SPIFlash_Write(&flash, 0xFFFFFF00, pattern, 0x200) == SPIFLASH_OUT_OF_RANGE);
+    CHECK(SPIFlash_Erase(&flash, 0xFFFFF000, 0x2000) == SPIFLASH_OUT_OF_RANGE);
+    CHECK(SPIFlash_Erase(&flash, 0, W25Q_CAPACITY + 1) == SPIFLASH_OUT_OF_RANGE);
+    CHECK(SPIFlash_Erase(&flash, 0, W25Q_CAPACITY) == SPIFLASH_OK);
+    Finish();
+    CHECK(w25q.erase64K == 2);
+}
+
+int main(void)
+{
+    Test_Init();
+    Test_WritePageSplit();
+    Test_EraseGranularity();
+    Test_EraseWriteRead();
+    Test_Bounds();
+
+    printf("SPIFlash: %s (%u failures)\n", hostFailures ? "FAIL" : "ok", (unsigned)hostFailures);
+    return hostFailures ? 1 : 0;
+}
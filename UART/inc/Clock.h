@@ -0,0 +1,63 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+
+// oscillators
+#define CLOCK_HSE 25000000
+#define CLOCK_HSI 16000000
+
+// PLL input divider: 25 MHz HSE / 25 = 1 MHz VCO input, shared with PLLI2S
+#define CLOCK_PLLM 25
+
+// STM32F401 limits (voltage scale 2, 2.7 - 3.6 V)
+#define CLOCK_SYSCLK_MAX 84000000
+#define CLOCK_APB1_MAX   42000000
+#define CLOCK_APB2_MAX   84000000
+#define CLOCK_SCALE3_MAX 60000000      // Highest SYSCLK in voltage scale 3
+
+// SYSCLK configured by SystemInit
+#define CLOCK_SYSCLK 84000000
+
+// maximum number of drivers notified of clock changes (Clock_Register)
+#define CLOCK_MAX_NOTIFIERS 8
+
+// use declared enum to read clock configuration status
+enum Clock_status
+{
+    CLOCK_OK,
+    CLOCK_INVALID,                  // Frequency not reachable (limits or PLL granularity)
+    CLOCK_FULL                      // No free notifier slot
+};
+
+// use declared enum to select the operating point (Clock_SetOperatingPoint)
+enum Clock_opPoint
+{
+    CLOCK_OP_16MHZ,                 // HSI, PLL off (HSE off too unless PLLI2S runs)
+    CLOCK_OP_42MHZ,                 // PLL, voltage scale 3
+    CLOCK_OP_84MHZ                  // PLL, full speed
+};
+
+// use declared enum to read the notification passed to Clock_Notifier
+enum Clock_event
+{
+    CLOCK_PRE_CHANGE,               // Old clock still running: let transfers finish, hold new ones
+    CLOCK_POST_CHANGE               // New clock running, interrupts masked: recompute dividers
+};
+
+// driver callback run before and after every operating point change
+typedef void (*Clock_Notifier)(uint8_t event);
+
+// function declaration
+uint8_t Clock_init(uint32_t sysclk);
+uint32_t Clock_GetHCLK(void);
+uint32_t Clock_GetPCLK1(void);
+uint32_t Clock_GetPCLK2(void);
+uint32_t Clock_GetTimerClock1(void);
+uint32_t Clock_GetTimerClock2(void);
+uint32_t Clock_GetBusClock(const void* peripheral);
+uint8_t Clock_Register(Clock_Notifier notifier);
+uint8_t Clock_SetOperatingPoint(uint8_t point);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef LOAD_H_
+#define LOAD_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "Time.h"
+#include "Event.h"
+#include "Profile.h"
+
+// set value as 1 to measure the CPU load from the time spent asleep in WFI (Time_sleepUntil);
+// with 0 the accounting hooks expand to nothing and no code or RAM is added
+#define LOAD_ENABLE 0
+
+// one load sample per LOAD_SAMPLE_US, averaged over the last LOAD_WINDOW samples (1 s)
+#define LOAD_SAMPLE_US 100000
+#define LOAD_WINDOW 10
+
+#if LOAD_ENABLE && !TIME_SLEEP_STATS
+#error "LOAD_ENABLE needs TIME_SLEEP_STATS"
+#endif
+
+// use declared struct to read the load (percent of CPU time not spent asleep)
+typedef struct
+{
+    uint8_t current;                // Last sample
+    uint8_t average;                // Mean of the last LOAD_WINDOW samples
+    uint8_t peak;                   // Highest sample since Load_Reset
+    uint32_t samples;               // Samples taken since Load_Reset
+} Load_Stats_Typedef;
+
+// time attributed to a task, handler or ISR, charged between LOAD_BEGIN and LOAD_END
+// ex: (in main code)
+// Load_Account_Typedef sensorLoad = { .name = "sensor" };
+// Load_Register(&sensorLoad);
+// void handler(uint32_t arg) { LOAD_BEGIN(); ... LOAD_END(&sensorLoad); }
+typedef struct Load_Account Load_Account_Typedef;
+
+struct Load_Account
+{
+    const char* name;
+    uint32_t cycles;                // Charged since the last complete window
+    uint8_t percent;                // Share of the last complete window
+    Load_Account_Typedef* next;
+};
+
+#if LOAD_ENABLE
+// first and last statement of an accounted section (one context per account)
+#define LOAD_BEGIN()            uint32_t loadStart = DWT->CYCCNT
+#define LOAD_END(account)       ((account)->cycles += DWT->CYCCNT - loadStart)
+
+// function declaration
+void Load_init(void);
+void Load_Register(Load_Account_Typedef* account);
+Load_Stats_Typedef* Load_GetStats(void);
+void Load_Reset(void);
+void Load_Dump(void (*print)(char* line));
+#else
+#define LOAD_BEGIN()
+#define LOAD_END(account)
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+
+// set value as 1 to record driver ISR execution times and interrupt latency with the DWT
+// cycle counter; with 0 the ISR hooks expand to nothing and no code or RAM is added
+#define PROFILE_ENABLE 0
+
+// log2 histogram: bucket 0 counts 0 cycles, bucket n counts 2^(n-1) .. 2^n - 1 cycles,
+// the last bucket everything above
+#define PROFILE_BUCKETS 16
+
+// latency probe period (TIM2 update interrupt)
+#define PROFILE_PROBE_HZ 1000
+
+// use declared enum to select the profiled interrupt
+enum Profile_id
+{
+    PROFILE_USART1,
+    PROFILE_USART2,
+    PROFILE_USART6,
+    PROFILE_SPI1,
+    PROFILE_SPI2,
+    PROFILE_SPI3,
+    PROFILE_SPI1_NSS,               // EXTI4, slave frame edges
+    PROFILE_SPI2_NSS,               // EXTI15_10, slave frame edges
+    PROFILE_I2S2_DMA,
+    PROFILE_I2S3_DMA,
+    PROFILE_I2C1_EV,
+    PROFILE_I2C1_ER,
+    PROFILE_I2C2_EV,
+    PROFILE_I2C2_ER,
+    PROFILE_I2C3_EV,
+    PROFILE_I2C3_ER,
+    PROFILE_I2C1_DMA,
+    PROFILE_I2C2_DMA,
+    PROFILE_I2C3_DMA,
+    PROFILE_TIM5,
+    PROFILE_LATENCY,                // Entry delay of the TIM2 probe, see Profile_init
+    PROFILE_COUNT
+};
+
+// use declared struct to read one histogram (cycles)
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;                 // Sum of all measurements (CPU share, see Load_Dump)
+    uint32_t histogram[PROFILE_BUCKETS];
+} Profile_Histogram_Typedef;
+
+#if PROFILE_ENABLE
+// first and last statement of a profiled ISR
+#define PROFILE_ISR_ENTER()     uint32_t profileStart = DWT->CYCCNT
+#define PROFILE_ISR_EXIT(id)    Profile_Record(id, DWT->CYCCNT - profileStart)
+
+// function declaration
+void Profile_init(void);
+void Profile_Record(uint8_t id, uint32_t cycles);
+Profile_Histogram_Typedef* Profile_Get(uint8_t id);
+const char* Profile_Name(uint8_t id);
+void Profile_Reset(void);
+void Profile_Dump(void (*print)(char* line));
+#else
+#define PROFILE_ISR_ENTER()
+#define PROFILE_ISR_EXIT(id)
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef TASK_H_
+#define TASK_H_
+
+#include <stdint.h>
+#include "stm32f401xc.h"
+#include "Time.h"
+#include "Event.h"
+#include "Load.h"
+
+// Stackless tasks (protothreads) run by the event loop. A task is a function that returns
+// whenever it has to wait and resumes at the same line on its next run, so a multi-step
+// device sequence reads top to bottom without a stack of its own:
+//
+// uint8_t sensorTask(Task_Typedef* task)
+// {
+//     TASK_BEGIN(task);
+//     TASK_AWAIT(task, I2C_Transfer_IT(I2C1, &xfer) == I2C_OK);  // Bus free: started
+//     TASK_AWAIT(task, xfer.status != I2C_BUSY);                 // xfer.event = Task_Signal
+//     TASK_DELAY_US(task, 5000);
+//     TASK_END(task);
+// }
+//
+// Rules: local variables do not survive a wait (keep state in task->context or statics),
+// one wait per source line, and no switch statement around a wait.
+
+// use declared enum to read task function result
+enum Task_status
+{
+    TASK_WAITING,
+    TASK_DONE
+};
+
+typedef struct Task Task_Typedef;
+typedef uint8_t (*Task_Function)(Task_Typedef* task);
+
+// task state: 20 bytes (24 with LOAD_ENABLE), no stack
+struct Task
+{
+    Task_Function function;         // Task body
+    void* context;                  // Free for the caller (state kept across waits)
+    Task_Typedef* next;             // Running tasks
+    uint32_t wakeAt;                // TASK_DELAY_US deadline
+    uint16_t line;                  // Resume point, 0: start
+    uint8_t running;
+    uint8_t sleeping;               // Waiting in TASK_DELAY_US
+    #if LOAD_ENABLE
+    Load_Account_Typedef* load;     // Charged with the task's run time (NULL: not attributed)
+    #endif
+};
+
+// task body markers
+#define TASK_BEGIN(task)    switch ((task)->line) { case 0:
+#define TASK_END(task)      } (task)->line = 0; return TASK_DONE
+
+// returns until condition holds; re-checked every time the task runs (Task_Signal)
+#define TASK_AWAIT(task, condition)                                             \
+    do { (task)->line = __LINE__; case __LINE__:                                \
+         if (!(condition)) return TASK_WAITING; } while (0)
+
+// lets the other handlers and tasks run, resumes from the event loop
+#define TASK_YIELD(task)                                                        \
+    do { (task)->line = __LINE__; Event_Post(Task_Resume, (uint32_t)(task));    \
+         return TASK_WAITING; case __LINE__:; } while (0)
+
+// sleeps without blocking the event loop (within 35 minutes)
+#define TASK_DELAY_US(task, us)                                                 \
+    do { Task_Sleep(task, us);                                                  \
+         TASK_AWAIT(task, Time_expired((task)->wakeAt));                        \
+         (task)->sleeping = 0; } while (0)
+
+// function declaration
+void Task_Start(Task_Typedef* task, Task_Function function, void* context);
+void Task_Stop(Task_Typedef* task);
+void Task_Signal(uint32_t arg);
+void Task_Resume(uint32_t task);
+void Task_Sleep(Task_Typedef* task, uint32_t us);
+
+#endif
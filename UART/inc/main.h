@@ -1,6 +1,14 @@
 #include "stm32f401xc.h"
+#include "Clock.h"
+#include "Time.h"
+#include "Event.h"
+#include "Task.h"
+#include "Profile.h"
+#include "Load.h"
+#include "Trace.h"
 #include "ringBuffer.h"
 #include "UART.h"
 
 extern void SystemInit(void);
-extern void Delay_ms(uint16_t ms);
+extern void Delay_us(uint32_t us);
+extern void Delay_ms(uint32_t ms);
@@ -0,0 +1,264 @@
+#include "Clock.h"
+
+// VCO output range and USB/SDIO clock limit (RM0368 6.3.2)
+#define VCO_MIN 192000000
+#define VCO_MAX 432000000
+#define PLL48_MAX 48000000
+
+// APB prescaler (PPREx) code to shift: 0xx = /1, 100 = /2, 101 = /4, 110 = /8, 111 = /16
+static const uint8_t apbShift[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+// SYSCLK of each operating point (enum Clock_opPoint)
+static const uint32_t opPoints[] = {CLOCK_HSI, 42000000, 84000000};
+
+// drivers notified around operating point changes, in registration order
+static Clock_Notifier notifiers[CLOCK_MAX_NOTIFIERS];
+static uint8_t notifierCount;
+
+/**
+ * @brief  Finds PLLN/PLLP for sysclk from the 1 MHz VCO input. PLLP is kept as small as the VCO
+ *         range allows; PLLQ keeps the 48 MHz domain at or below its limit.
+ * @return 1 and the PLLCFGR value, 0 if sysclk is not reachable
+ */
+static uint8_t Clock_ComputePLL(uint32_t sysclk, uint32_t* pllcfgr)
+{
+    uint32_t input = CLOCK_HSE / CLOCK_PLLM;
+
+    for (uint32_t p = 2; p <= 8; p += 2)
+    {
+        uint32_t vco = sysclk * p;
+
+        if ((vco % input) || vco < VCO_MIN || vco > VCO_MAX)
+        {
+            continue;
+        }
+
+        uint32_t q = (vco + PLL48_MAX - 1) / PLL48_MAX;
+        if (q < 2)
+        {
+            q = 2;
+        }
+
+        *pllcfgr = RCC_PLLCFGR_PLLSRC_HSE
+                 | (CLOCK_PLLM << RCC_PLLCFGR_PLLM_Pos)
+                 | ((vco / input) << RCC_PLLCFGR_PLLN_Pos)
+                 | (((p / 2) - 1) << RCC_PLLCFGR_PLLP_Pos)     // 00: /2, 01: /4, 10: /6, 11: /8
+                 | (q << RCC_PLLCFGR_PLLQ_Pos);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Smallest APB prescaler code keeping the bus at or below its limit.
+ */
+static uint32_t Clock_APBPrescaler(uint32_t hclk, uint32_t limit)
+{
+    uint32_t code = 0;                              // /1
+
+    while ((hclk >> apbShift[code]) > limit && code < 7)
+    {
+        code = (code == 0) ? 4 : code + 1;          // /2, /4, /8, /16
+    }
+    return code;
+}
+
+/************************************** Setup clock tree **************************************
+ * @brief  Configures SYSCLK (HSI, HSE, or PLL from HSE up to 84 MHz), flash wait states and
+ *         APB prescalers within the STM32F401 limits, then updates SystemCoreClock.
+ *         The core runs from HSI while the PLL is reprogrammed, so this can be called again
+ *         at run time.
+ *
+ * @param  sysclk: Requested SYSCLK in Hz (CLOCK_HSI, CLOCK_HSE or a whole MHz PLL frequency)
+ * @return CLOCK_OK, or CLOCK_INVALID (clock tree left untouched)
+ * @note   Peripherals keep the registers computed for the previous clock; use
+ *         Clock_SetOperatingPoint to have the registered drivers follow a change.
+ */
+uint8_t Clock_init(uint32_t sysclk)
+{
+    uint32_t source;
+    uint32_t pllcfgr = 0;
+
+    if (sysclk == CLOCK_HSI)
+    {
+        source = RCC_CFGR_SW_HSI;
+    }
+    else if (sysclk == CLOCK_HSE)
+    {
+        source = RCC_CFGR_SW_HSE;
+    }
+    else if (sysclk <= CLOCK_SYSCLK_MAX && Clock_ComputePLL(sysclk, &pllcfgr))
+    {
+        source = RCC_CFGR_SW_PLL;
+    }
+    else
+    {
+        return CLOCK_INVALID;
+    }
+
+    uint32_t latency = (sysclk - 1) / 30000000;     // One wait state per 30 MHz (2.7 - 3.6 V)
+    uint32_t ppre1 = Clock_APBPrescaler(sysclk, CLOCK_APB1_MAX);
+    uint32_t ppre2 = Clock_APBPrescaler(sysclk, CLOCK_APB2_MAX);
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;              // Enable Power interface clock
+
+    RCC->CR |= RCC_CR_HSION | RCC_CR_HSEON;         // HSI to run on meanwhile, HSE for the PLLs
+    while (!(RCC->CR & RCC_CR_HSIRDY));
+    while (!(RCC->CR & RCC_CR_HSERDY));
+
+    // 1. Wait states for the faster of the old and new clock, then move to HSI
+    if ((FLASH->ACR & FLASH_ACR_LATENCY) < latency)
+    {
+        FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+    }
+    FLASH->ACR |= FLASH_ACR_DCEN                    // Enable data cache
+                | FLASH_ACR_PRFTEN                  // Enable prefetch
+                | FLASH_ACR_ICEN;                   // Enable instruction cache
+
+    RCC->CFGR &= ~RCC_CFGR_SW;                      // SYSCLK from HSI
+    while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI);
+
+    // 2. Reprogram the PLL (it must be off while PLLCFGR and VOS change)
+    RCC->CR &= ~RCC_CR_PLLON;
+    while (RCC->CR & RCC_CR_PLLRDY);
+    if (source == RCC_CFGR_SW_PLL)
+    {
+        // Lowest regulator scale that supports sysclk: scale 3 up to 60 MHz, else scale 2
+        PWR->CR = (PWR->CR & ~PWR_CR_VOS) | ((sysclk > CLOCK_SCALE3_MAX) ? PWR_CR_VOS_1 : PWR_CR_VOS_0);
+        RCC->PLLCFGR = pllcfgr;
+        RCC->CR |= RCC_CR_PLLON;
+        while (!(RCC->CR & RCC_CR_PLLRDY));
+    }
+
+    // 3. Bus prescalers, then the new SYSCLK source
+    RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2))
+              | RCC_CFGR_HPRE_DIV1
+              | (ppre1 << RCC_CFGR_PPRE1_Pos)
+              | (ppre2 << RCC_CFGR_PPRE2_Pos);
+
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | source;
+    while ((RCC->CFGR & RCC_CFGR_SWS) != (source << RCC_CFGR_SWS_Pos));
+
+    // 4. Drop wait states the new clock does not need, and HSE if nothing runs from it
+    FLASH->ACR = (FLASH->ACR & ~FLASH_ACR_LATENCY) | latency;
+    if (source == RCC_CFGR_SW_HSI && !(RCC->CR & RCC_CR_PLLI2SON))
+    {
+        RCC->CR &= ~RCC_CR_HSEON;
+    }
+
+    SystemCoreClockUpdate();
+    return CLOCK_OK;
+}
+
+/************************************** Bus clocks ********************************************
+ * @brief  Clock getters decoded from the running configuration. Timer kernel clocks are twice
+ *         the APB clock whenever the APB prescaler divides.
+ *
+ * @param  peripheral: Peripheral base address (Clock_GetBusClock)
+ * @return Frequency in Hz
+ */
+uint32_t Clock_GetHCLK(void)
+{
+    return SystemCoreClock;
+}
+
+uint32_t Clock_GetPCLK1(void)
+{
+    return SystemCoreClock >> apbShift[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+uint32_t Clock_GetPCLK2(void)
+{
+    return SystemCoreClock >> apbShift[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+}
+
+uint32_t Clock_GetTimerClock1(void)
+{
+    uint8_t divided = ((RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos) >= 4;
+    return Clock_GetPCLK1() << divided;
+}
+
+uint32_t Clock_GetTimerClock2(void)
+{
+    uint8_t divided = ((RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos) >= 4;
+    return Clock_GetPCLK2() << divided;
+}
+
+uint32_t Clock_GetBusClock(const void* peripheral)
+{
+    uint32_t address = (uint32_t)peripheral;
+
+    if (address < APB2PERIPH_BASE)
+    {
+        return Clock_GetPCLK1();                    // TIM2-5, SPI2/3, USART2, I2C1-3
+    }
+    if (address < AHB1PERIPH_BASE)
+    {
+        return Clock_GetPCLK2();                    // TIM1/9-11, SPI1/4, USART1/6, ADC
+    }
+    return Clock_GetHCLK();
+}
+
+/*********************************** Reclock notifications ************************************
+ * @brief  Registers a driver callback run before (CLOCK_PRE_CHANGE) and after
+ *         (CLOCK_POST_CHANGE) every operating point change. Registering the same callback
+ *         again is harmless, so drivers register from their init functions.
+ *
+ * @param  notifier: Driver callback
+ * @return CLOCK_OK, or CLOCK_FULL if CLOCK_MAX_NOTIFIERS callbacks are registered
+ */
+uint8_t Clock_Register(Clock_Notifier notifier)
+{
+    for (uint8_t i = 0; i < notifierCount; i++)
+    {
+        if (notifiers[i] == notifier)
+        {
+            return CLOCK_OK;
+        }
+    }
+    if (notifierCount == CLOCK_MAX_NOTIFIERS)
+    {
+        return CLOCK_FULL;
+    }
+    notifiers[notifierCount++] = notifier;
+    return CLOCK_OK;
+}
+
+/************************************* Operating point ****************************************
+ * @brief  Switches SYSCLK at run time, e.g. 16 MHz while idle and 84 MHz for bursts. Registered
+ *         drivers get CLOCK_PRE_CHANGE first (interrupts enabled, so running transfers can
+ *         finish), then the clock tree is switched and CLOCK_POST_CHANGE lets them recompute
+ *         BRR, CCR, prescalers and PSC before any interrupt sees the new clock, so links keep
+ *         their bit rate.
+ *
+ * @param  point: CLOCK_OP_16MHZ, CLOCK_OP_42MHZ or CLOCK_OP_84MHZ
+ * @return CLOCK_OK or CLOCK_INVALID
+ * @note   Call from the main loop, not from an interrupt. Interrupts stay masked while the PLL
+ *         locks (a few hundred microseconds).
+ */
+uint8_t Clock_SetOperatingPoint(uint8_t point)
+{
+    if (point >= sizeof(opPoints) / sizeof(opPoints[0]))
+    {
+        return CLOCK_INVALID;
+    }
+    if (opPoints[point] == SystemCoreClock)
+    {
+        return CLOCK_OK;
+    }
+
+    for (uint8_t i = 0; i < notifierCount; i++)
+    {
+        notifiers[i](CLOCK_PRE_CHANGE);
+    }
+
+    __disable_irq();
+    uint8_t status = Clock_init(opPoints[point]);
+    for (uint8_t i = 0; i < notifierCount; i++)
+    {
+        notifiers[i](CLOCK_POST_CHANGE);
+    }
+    __enable_irq();
+
+    return status;
+}
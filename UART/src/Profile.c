@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include "Profile.h"
+#include "Clock.h"
+
+#if PROFILE_ENABLE
+
+static Profile_Histogram_Typedef profiles[PROFILE_COUNT];
+
+static const char* const profileNames[PROFILE_COUNT] = {
+    "USART1", "USART2", "USART6", "SPI1", "SPI2", "SPI3", "SPI1 NSS", "SPI2 NSS",
+    "I2S2 DMA", "I2S3 DMA", "I2C1 EV", "I2C1 ER", "I2C2 EV", "I2C2 ER", "I2C3 EV", "I2C3 ER",
+    "I2C1 DMA", "I2C2 DMA", "I2C3 DMA", "TIM5", "Latency"
+};
+
+/**
+ * @brief  Reclock notification: keeps the probe period when the timer clock changes.
+ */
+static void Profile_Reclock(uint8_t event)
+{
+    if (event == CLOCK_POST_CHANGE)
+    {
+        TIM2->ARR = (Clock_GetTimerClock1() / PROFILE_PROBE_HZ) - 1;
+    }
+}
+
+/************************************** Setup profiling ***************************************
+ * @brief  Starts the DWT cycle counter and the latency probe: TIM2 counts at the APB1 timer
+ *         clock and raises its update interrupt PROFILE_PROBE_HZ times per second. The count
+ *         read first thing in the probe ISR is the time the interrupt waited (masked sections,
+ *         other ISRs of equal or higher priority, and the 12 cycle entry). The timer clock
+ *         equals HCLK at every operating point (APB1 /1 or /2), so timer ticks are cycles.
+ */
+void Profile_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // Enable DWT
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // Start cycle counter
+
+    Profile_Reset();
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    TIM2->PSC = 0;
+    TIM2->ARR = (Clock_GetTimerClock1() / PROFILE_PROBE_HZ) - 1;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+    NVIC_EnableIRQ(TIM2_IRQn);
+    Clock_Register(Profile_Reclock);
+
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+/**
+ * @brief  Adds one measurement; called from PROFILE_ISR_EXIT.
+ */
+void Profile_Record(uint8_t id, uint32_t cycles)
+{
+    Profile_Histogram_Typedef* profile = &profiles[id];
+    uint32_t bucket = 32 - __CLZ(cycles);               // 0 -> 0, 1 -> 1, 2..3 -> 2, ...
+
+    if (bucket >= PROFILE_BUCKETS)
+    {
+        bucket = PROFILE_BUCKETS - 1;
+    }
+    profile->histogram[bucket]++;
+    profile->count++;
+    profile->total += cycles;
+    if (cycles < profile->min)
+    {
+        profile->min = cycles;
+    }
+    if (cycles > profile->max)
+    {
+        profile->max = cycles;
+    }
+}
+
+/**
+ * @brief  Returns the histogram and the name of one interrupt (PROFILE_USART1 ... PROFILE_LATENCY).
+ */
+Profile_Histogram_Typedef* Profile_Get(uint8_t id)
+{
+    return &profiles[id];
+}
+
+const char* Profile_Name(uint8_t id)
+{
+    return profileNames[id];
+}
+
+/**
+ * @brief  Clears every histogram.
+ */
+void Profile_Reset(void)
+{
+    __disable_irq();
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++)
+    {
+        profiles[i] = (Profile_Histogram_Typedef){ .min = UINT32_MAX };
+    }
+    __enable_irq();
+}
+
+/************************************** Console dump ******************************************
+ * @brief  Prints one line per interrupt that ran: count, min/max cycles, then the non-empty
+ *         buckets as "<limit:count", e.g. "I2C1 EV n=42 min=96 max=410 <128:30 <512:12".
+ *
+ * @param  print: Line output, e.g. Log_s
+ */
+void Profile_Dump(void (*print)(char* line))
+{
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++)
+    {
+        Profile_Histogram_Typedef profile = profiles[i];    // Snapshot, ISRs keep recording
+        char line[160];
+        int length;
+
+        if (!profile.count)
+        {
+            continue;
+        }
+        length = snprintf(line, sizeof(line), "%s n=%lu min=%lu max=%lu", profileNames[i],
+                          (unsigned long)profile.count, (unsigned long)profile.min,
+                          (unsigned long)profile.max);
+        for (uint8_t b = 0; b < PROFILE_BUCKETS && length < (int)sizeof(line); b++)
+        {
+            if (profile.histogram[b])
+            {
+                length += snprintf(&line[length], sizeof(line) - length,
+                                   (b == PROFILE_BUCKETS - 1) ? " >=%lu:%lu" : " <%lu:%lu",
+                                   (b == PROFILE_BUCKETS - 1) ? (1UL << (b - 1)) : (1UL << b),
+                                   (unsigned long)profile.histogram[b]);
+            }
+        }
+        print(line);
+    }
+}
+
+/****************************************** ISR ***********************************************/
+void TIM2_IRQHandler(void)
+{
+    uint32_t latency = TIM2->CNT;                       // Ticks since the update event
+
+    TIM2->SR = (uint32_t)~TIM_SR_UIF;                   // rc_w0: clear UIF only
+    Profile_Record(PROFILE_LATENCY, latency);
+}
+
+#endif
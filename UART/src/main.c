@@ -1,11 +1,8 @@
 #include "main.h"
 
-#define SysCoreClk 42000000    // System core clock frequency (Hz)
-
 /* UART1 configuration: 9600 baud, TX only, no parity, 1 stop bit */
 UART_Typedef UART1_config = {
         .baudRate = 9600,               // UART baud rate
-        .peripheralClock = SysCoreClk,  // Peripheral clock frequency
         .mode = UART_TX,                // UART mode: transmit only
         .ParityEnable = 0,              // Parity disabled
         .Parity = 0,                    // Even parity (not used since ParityEnable=0)
@@ -15,7 +12,6 @@ UART_Typedef UART1_config = {
 /* UART6 configuration: 9600 baud, TX/RX, no parity, 1 stop bit */
 UART_Typedef UART6_config = {
         .baudRate = 9600,               // UART baud rate
-        .peripheralClock = SysCoreClk,  // Peripheral clock frequency
         .mode = UART_TX_RX,             // UART mode: transmit and receive
         .ParityEnable = 0,              // Parity disabled
         .Parity = 0,                    // Even parity (not used since ParityEnable=0)
@@ -24,9 +20,33 @@ UART_Typedef UART6_config = {
 
 ringBuffer_Typedef UART6_Buff;          // Ring buffer for UART6 (for interrupt-driven RX/TX)
 
+/**
+ * @brief  Timer callback: sends the greeting from UART1 once a second.
+ */
+static void sendHello(uint32_t arg)
+{
+    char* s = "Hello World from UART 1 :)\n\r";    // Message to send via UART1
+    while (*s)
+    {
+        UART_Write(UART1, *s);              // Transmit each character via UART1
+        s++;
+    }
+}
+
+/**
+ * @brief  UART6 RX event: echoes the ring buffer content as soon as data arrives.
+ */
+static void onUART6Rx(uint32_t byte)
+{
+    UART_EnableInterrupts_Tx(UART6);        // Enable TX interrupt for UART6 to transmit the buffer
+}
+
+Event_Timer_Typedef helloTimer = { .callback = sendHello };
+
 /**
  * @brief  Main program entry point.
- *         Initializes system, configures UART1 and UART6, and repeatedly sends a message from UART1.
+ *         Initializes system, configures UART1 and UART6, then runs the event loop: a timer
+ *         sends a message from UART1 every second and UART6 echoes what it receives.
  */
 int main(void)
 {
@@ -37,19 +57,10 @@ int main(void)
 
     ringBuffer_init(&UART6_Buff);       // Initialize ring buffer for UART6[3]
 
-    while (1)
-    {
-        UART_EnableInterrupts_Rx(UART6);     // Enable RX interrupt for UART6 to receive incoming data
-
-        char* s = "Hello World from UART 1 :)\n\r"; // Message to send via UART1
-        while (*s)
-        {
-            UART_Write(UART1, *s);          // Transmit each character via UART1
-            s++;
-        }
+    UART_SetRxEvent(UART6, onUART6Rx);  // Received bytes are handled from the event loop
+    UART_EnableInterrupts_Rx(UART6);    // Enable RX interrupt for UART6 to receive incoming data
 
-        UART_EnableInterrupts_Tx(UART6);    // Enable TX interrupt for UART6 to transmit data (if any in buffer)
+    Event_TimerStart(&helloTimer, 0, 1000000);  // First message now, then every second
 
-        Delay_ms(1000);                     // Delay 1 second before next transmission
-    }
-}
\ No newline at end of file
+    Event_Run();                        // Sleeps until a timer expires or an interrupt posts
+}
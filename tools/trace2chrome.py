@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Convert a driver trace buffer (Trace.h) into Chrome trace JSON.
+
+The input is the raw image of traceBuffer, either read by the debugger
+    (gdb) dump binary value trace.bin traceBuffer
+or captured from the log output while the firmware runs Trace_Dump(Log_b). A USART1
+capture may contain log text around the image; the image is found by its "TRC1" magic.
+With LOG_ITM the SWO capture is a stream of ITM packets: --itm keeps only the payload of
+stimulus port 1 (LOG_ITM_DATA_PORT) and drops port 0 text, sync and other packets.
+
+    python3 tools/trace2chrome.py trace.bin trace.json
+    python3 tools/trace2chrome.py --itm swo.bin trace.json
+
+Open the result in chrome://tracing or https://ui.perfetto.dev: one row per peripheral,
+START..DONE pairs become slices, errors, received bytes and marks become instant events.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b"TRC1"
+HEADER = struct.Struct("<IHHII")        # magic, size, running, clockHz, next
+RECORD = struct.Struct("<IBBH")         # cycles, event, source, arg
+ITM_DATA_PORT = 1                       # LOG_ITM_DATA_PORT in Log.h
+
+# same order as enum Trace_source / enum Trace_event in Trace.h
+SOURCES = ["Clock", "USART1", "USART2", "USART6", "SPI1", "SPI2", "SPI3",
+           "I2C1", "I2C2", "I2C3", "App"]
+START, DONE, ERROR, BYTES, RX, RECLOCK, MARK = range(7)
+EVENT_NAMES = {ERROR: "error", BYTES: "slave", RX: "rx", RECLOCK: "reclock", MARK: "mark"}
+
+
+def source_name(source):
+    return SOURCES[source] if source < len(SOURCES) else "source %d" % source
+
+
+def itm_port_payload(data, port):
+    """Returns the bytes written to one ITM stimulus port, from a raw SWO capture (TPIU
+    formatter off, as set by Log_init)."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        header = data[i]
+        i += 1
+        if header == 0x00 or header == 0x80 or header == 0x70:
+            continue                            # Sync bytes, overflow
+        if header & 0x03:
+            size = (1, 2, 4)[(header & 0x03) - 1]
+            if not header & 0x04 and header >> 3 == port:
+                out += data[i:i + size]         # Instrumentation packet of our port
+            i += size                           # Other ports, hardware source packets
+        else:
+            while header & 0x80 and i < len(data):
+                header = data[i]                # Timestamp/extension: continuation bytes
+                i += 1
+    return bytes(out)
+
+
+def load_records(data):
+    """Returns (clock of the oldest record, records in time order) from the buffer image."""
+    offset = data.find(MAGIC)
+    if offset < 0:
+        sys.exit("no trace buffer (magic TRC1) in input")
+    _, size, _, clock_hz, written = HEADER.unpack_from(data, offset)
+    base = offset + HEADER.size
+    if len(data) < base + size * RECORD.size:
+        sys.exit("trace buffer truncated: %d records expected" % size)
+
+    slots = [RECORD.unpack_from(data, base + i * RECORD.size) for i in range(size)]
+    if written <= size:
+        return clock_hz, slots[:written]
+    first = written % size                      # Oldest record, next to be overwritten
+    return clock_hz, slots[first:] + slots[:first]
+
+
+def convert(clock_hz, records):
+    """Returns the Chrome trace event list; cycle stamps are unwrapped and scaled by the
+    clock in force, which TRACE_RECLOCK records update."""
+    events = [{"ph": "M", "name": "thread_name", "pid": 0, "tid": i, "args": {"name": name}}
+              for i, name in enumerate(SOURCES)]
+    open_slices = {}
+    time_us = 0.0
+    last = None
+
+    for cycles, event, source, arg in records:
+        if last is not None:
+            time_us += ((cycles - last) & 0xFFFFFFFF) * 1e6 / clock_hz
+        last = cycles
+        name = source_name(source)
+
+        if event == START:
+            open_slices.setdefault(source, (time_us, arg))      # Repeated START: keep the first
+        elif event == DONE:
+            if source in open_slices:
+                begin, start_arg = open_slices.pop(source)
+                events.append({"ph": "X", "name": name, "pid": 0, "tid": source,
+                               "ts": begin, "dur": time_us - begin,
+                               "args": {"start": start_arg, "bytes": arg}})
+        else:
+            if event == RECLOCK:
+                clock_hz = arg * 1000000
+            events.append({"ph": "i", "s": "t", "name": EVENT_NAMES.get(event, "event %d" % event),
+                           "pid": 0, "tid": source, "ts": time_us,
+                           "args": {"arg": "0x%04X" % arg}})
+
+    for source, (begin, start_arg) in open_slices.items():      # Still running at the dump
+        events.append({"ph": "B", "name": source_name(source), "pid": 0, "tid": source,
+                       "ts": begin, "args": {"start": start_arg}})
+    return events
+
+
+def main():
+    args = sys.argv[1:]
+    itm = "--itm" in args
+    if itm:
+        args.remove("--itm")
+    if len(args) != 2:
+        sys.exit("usage: trace2chrome.py [--itm] <trace.bin> <trace.json>")
+    with open(args[0], "rb") as f:
+        data = f.read()
+    if itm:
+        data = itm_port_payload(data, ITM_DATA_PORT)
+    clock_hz, records = load_records(data)
+    with open(args[1], "w") as f:
+        json.dump({"traceEvents": convert(clock_hz, records), "displayTimeUnit": "ns"}, f)
+    print("%d records" % len(records))
+
+
+if __name__ == "__main__":
+    main()